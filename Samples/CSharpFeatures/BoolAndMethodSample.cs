@@ -10,7 +10,7 @@ namespace Samples.CSharpFeatures
         private static bool ShouldLoopB;
         private static bool ShouldLoopC = true;
 
-        static void Main()
+        public static void Main()
         {
             SetShouldLoopAToTrue();
             SetShouldLoopBToTrue();
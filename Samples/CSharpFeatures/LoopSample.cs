@@ -0,0 +1,34 @@
+﻿using System.Collections.Generic;
+using VCSFramework;
+using static VCSFramework.Registers;
+
+namespace Samples.CSharpFeatures
+{
+    // Not a proper VCS program.
+    static class LoopSample
+    {
+        [RomDataGenerator(nameof(GenerateColors))]
+        private static readonly RomData<byte> Colors = default;
+
+        public static void Main()
+        {
+            while (true)
+            {
+                // 'i' is only ever assigned, incremented, compared, and used as an index, so with optimizations
+                // enabled it's held in a register (INX/CPX/LDA Colors,X) instead of zero-page.
+                for (byte i = 0; i < 8; i++)
+                {
+                    ColuBk = Colors[i];
+                }
+            }
+        }
+
+        private static IEnumerable<byte> GenerateColors()
+        {
+            for (var i = 0; i < 8; i++)
+            {
+                yield return (byte)(i * 16);
+            }
+        }
+    }
+}
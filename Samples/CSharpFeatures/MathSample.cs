@@ -0,0 +1,36 @@
+﻿using VCSFramework;
+using static VCSFramework.Registers;
+
+namespace Samples.CSharpFeatures
+{
+    // Not a proper VCS program.
+    static class MathSample
+    {
+        private static byte A = 7;
+        private static byte B = 3;
+        private static byte Result;
+
+        public static void Main()
+        {
+        Loop:
+            // Variable operands, lowered according to CompilerOptions.MathStrategy.
+            Result = (byte)(A * B);
+            Result = (byte)(A / B);
+            Result = (byte)(A % B);
+            Result = (byte)(A << B);
+            Result = (byte)(A >> B);
+            // Constant operands, lowered to shifts/adds/masks.
+            Result = (byte)(A * 10);
+            Result = (byte)(A / 4);
+            Result = (byte)(A / 3);
+            Result = (byte)(A % 8);
+            Result = (byte)(A << 2);
+            Result = (byte)(A >> 1);
+            // Constants above 255 are ushorts, which are larger than any byte dividend.
+            Result = (byte)(A / 300);
+            Result = (byte)(A % 300);
+            ColuBk = Result;
+            goto Loop;
+        }
+    }
+}
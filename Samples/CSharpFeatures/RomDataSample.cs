@@ -12,6 +12,9 @@ namespace Samples.CSharpFeatures
         private static readonly RomData<UserByte> UserByteRomData;
         [RomDataGenerator(nameof(GenerateUserStructData))]
         private static readonly RomData<UserStruct> UserStructRomData;
+        // Relative to this source file.
+        [RomDataFile("RomDataSample.bin")]
+        private static readonly RomData<byte> FileRomData;
 
         private static byte ByteDataIndex = 0;
 
@@ -23,11 +26,10 @@ namespace Samples.CSharpFeatures
                 {
                     ColuBk = value;
                 }
+                ColuBk = FileRomData[ByteDataIndex];
             }
         }
 
-        // For a type used as a RomData<> arg to be accessible to the compiler, it MUST be public.
-        // This is because the compiler uses instances with `dynamic` variables, which respects accessibility.
         public struct UserByte
         {
             public byte Value;
@@ -0,0 +1,40 @@
+﻿using VCSFramework;
+using static VCSFramework.Registers;
+
+namespace Samples.CSharpFeatures
+{
+    // Not a proper VCS program.
+    static class WideMathSample
+    {
+        private static ushort Score;
+        private static ushort Timer = 1000;
+        private static short Offset;
+        private static short Delta = -3;
+        private static Fixed8_8 Position;
+        private static Fixed8_8 Velocity;
+
+        public static void Main()
+        {
+            // 1.5 pixels per frame.
+            Velocity.Raw = 0x0180;
+        Loop:
+            // 16-bit math happens in place, with a carry between the bytes.
+            Score++;
+            Score += 300;
+            Timer--;
+            Offset += Delta;
+            for (short i = -10; i < 10; i++)
+                Offset++;
+            // 1000 is a ushort constant, which compares with a short the same way it does in C#.
+            while (Offset < 1000)
+                Offset += 100;
+            // Sub-pixel movement.
+            Position += Velocity;
+            if (Position > 160)
+                Position = 0;
+            ColuBk = (byte)Position;
+            ColuPf = (byte)(Score >> 8);
+            goto Loop;
+        }
+    }
+}
@@ -8,10 +8,20 @@ namespace Samples
     public static class StandardTemplateSample
     {
         private static byte BackgroundColor;
+        private static byte FrameCount;
+        private static byte SlowCount;
 
         [VBlank]
         public static void ResetBackgroundColor() => BackgroundColor = 0;
 
+        [Overscan]
+        public static void CountFrames() => FrameCount++;
+
+        // Only needs to run every 4th frame, and can be put off to a later frame if there isn't enough time.
+        // The scheduler picks whether it goes in VBlank or Overscan.
+        [Schedule(estimatedScanlines: 1, period: 4, priority: SchedulePriority.Normal)]
+        public static void CountSlowly() => SlowCount++;
+
         [Kernel(KernelType.EveryScanline)]
         [KernelScanlineRange(192, 96)]
         public static void KernelAscend()
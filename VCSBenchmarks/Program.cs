@@ -0,0 +1,249 @@
+﻿#nullable enable
+using System;
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.Diagnostics;
+using System.IO;
+using System.Linq;
+using System.Text;
+using System.Text.Json;
+using System.Text.Json.Serialization;
+using VCSCompiler;
+
+namespace VCSBenchmarks
+{
+    internal sealed record SampleResult
+    {
+        /// <summary>Path of the sample, relative to the samples directory.</summary>
+        public string Sample { get; init; } = "";
+        public bool Optimized { get; init; }
+        public bool IsSuccessful { get; init; }
+        public int RomBytes { get; init; }
+        public int RamBytes { get; init; }
+        public int AssemblerPasses { get; init; }
+        [JsonIgnore]
+        public int TotalMacros => MacroCounts.Values.Sum();
+        public Dictionary<string, int> MacroCounts { get; init; } = new();
+        public Dictionary<string, double> PhaseMilliseconds { get; init; } = new();
+        public double TotalMilliseconds { get; init; }
+
+        [JsonIgnore]
+        public string Key => $"{Sample} ({(Optimized ? "optimized" : "unoptimized")})";
+    }
+
+    internal sealed record BenchmarkFile
+    {
+        public List<SampleResult> Results { get; init; } = new();
+    }
+
+    class Program
+    {
+        private static readonly JsonSerializerOptions JsonOptions = new() { WriteIndented = true };
+
+        /// <summary>
+        /// Macros that a sample has to use when optimized, keyed by sample. When an optimization silently stops applying,
+        /// the sample just grows back to its unoptimized size, which a baseline recorded afterwards wouldn't flag.
+        /// </summary>
+        private static readonly ImmutableDictionary<string, ImmutableArray<string>> RequiredMacros = new Dictionary<string, ImmutableArray<string>>
+        {
+            ["CSharpFeatures/LoopSample.cs"] = ImmutableArray.Create("assignConstantToRegister", "incrementRegister", "branchIfRegisterLessThanConstant", "pushRomDataElementFromRegister"),
+        }.ToImmutableDictionary();
+
+        /// <summary>
+        /// Compiles every sample with optimizations on and off, then compares ROM size, RAM usage, macro counts,
+        /// assembler passes, and (optionally) compile time against a baseline. Returns 1 if anything regressed, has no baseline,
+        /// or is missing a macro listed in <see cref="RequiredMacros"/>.
+        /// </summary>
+        /// <param name="samplesDirectory">Directory to search for sample .cs files. Defaults to the repo's Samples directory.</param>
+        /// <param name="baselinePath">Baseline file to compare against. Defaults to baseline.json next to this project.</param>
+        /// <param name="outputPath">If provided, the results of this run are written here.</param>
+        /// <param name="updateBaseline">True to overwrite the baseline with the results of this run instead of comparing.</param>
+        /// <param name="threshold">Allowed growth, as a fraction, before a size metric counts as a regression.</param>
+        /// <param name="timeThreshold">Allowed growth, as a fraction, before compile time counts as a regression.
+        /// If not provided, compile time is reported but never fails the run, since it's too noisy on shared machines.</param>
+        /// <param name="filter">Only run samples whose path contains this string.</param>
+        static int Main(
+            string? samplesDirectory = null,
+            string? baselinePath = null,
+            string? outputPath = null,
+            bool updateBaseline = false,
+            double threshold = 0.0,
+            double? timeThreshold = null,
+            string? filter = null)
+        {
+            var repoRoot = FindRepoRoot();
+            samplesDirectory ??= Path.Combine(repoRoot, "Samples");
+            baselinePath ??= Path.Combine(repoRoot, "VCSBenchmarks", "baseline.json");
+
+            var samples = Directory.EnumerateFiles(samplesDirectory, "*.cs", SearchOption.AllDirectories)
+                .Where(p => !p.Split(Path.DirectorySeparatorChar).Any(d => d == "obj" || d == "bin"))
+                .Where(p => filter == null || p.Contains(filter, StringComparison.OrdinalIgnoreCase))
+                .OrderBy(p => p)
+                .ToImmutableArray();
+
+            var outputDirectory = Path.Combine(Path.GetTempPath(), "VCSBenchmarks");
+            Directory.CreateDirectory(outputDirectory);
+
+            var results = new List<SampleResult>();
+            foreach (var sample in samples)
+            {
+                foreach (var optimized in new[] { true, false })
+                {
+                    var result = Run(sample, Path.GetRelativePath(samplesDirectory, sample).Replace('\\', '/'), optimized, outputDirectory);
+                    results.Add(result);
+                }
+            }
+            var current = new BenchmarkFile { Results = results };
+
+            if (outputPath != null)
+                File.WriteAllText(outputPath, JsonSerializer.Serialize(current, JsonOptions));
+
+            // Checked before updating too, so a baseline can't be recorded with an optimization turned off.
+            var missingMacros = results.SelectMany(FindMissingMacros).ToImmutableArray();
+            if (missingMacros.Any())
+            {
+                Console.WriteLine("Missing required macros:");
+                foreach (var missingMacro in missingMacros)
+                    Console.WriteLine($"  {missingMacro}");
+                return 1;
+            }
+
+            if (updateBaseline)
+            {
+                File.WriteAllText(baselinePath, JsonSerializer.Serialize(current, JsonOptions));
+                Console.WriteLine($"Wrote {results.Count} results to baseline '{baselinePath}'.");
+                Console.WriteLine(FormatTable(results, ImmutableDictionary<string, SampleResult>.Empty));
+                return 0;
+            }
+
+            var baseline = File.Exists(baselinePath)
+                ? JsonSerializer.Deserialize<BenchmarkFile>(File.ReadAllText(baselinePath)) ?? new BenchmarkFile()
+                : new BenchmarkFile();
+            var baselineByKey = baseline.Results.ToImmutableDictionary(r => r.Key);
+            Console.WriteLine(FormatTable(results, baselineByKey));
+
+            var regressions = results.SelectMany(r => baselineByKey.TryGetValue(r.Key, out var b) ? FindRegressions(b, r, threshold, timeThreshold) : Enumerable.Empty<string>())
+                .ToImmutableArray();
+            // A sample without a baseline can't be checked, so it fails the run rather than silently passing.
+            var missing = results.Where(r => !baselineByKey.ContainsKey(r.Key)).ToImmutableArray();
+            if (missing.Any())
+                Console.WriteLine($"No baseline for: {string.Join(", ", missing.Select(r => r.Key))}. Run with --update-baseline to record them.");
+
+            if (regressions.Any())
+            {
+                Console.WriteLine("Regressions:");
+                foreach (var regression in regressions)
+                    Console.WriteLine($"  {regression}");
+            }
+            if (regressions.Any() || missing.Any())
+                return 1;
+            Console.WriteLine("No regressions.");
+            return 0;
+        }
+
+        private static SampleResult Run(string samplePath, string sampleName, bool optimized, string outputDirectory)
+        {
+            var outputPath = Path.Combine(outputDirectory, $"{sampleName.Replace('/', '_')}.{(optimized ? "opt" : "noopt")}.bin");
+            var options = new CompilerOptions
+            {
+                OutputPath = outputPath,
+                DisableOptimizations = !optimized
+            };
+
+            var stopwatch = Stopwatch.StartNew();
+            RomInfo romInfo;
+            try
+            {
+                romInfo = Compiler.CompileFromFile(samplePath, options);
+            }
+            catch (Exception e)
+            {
+                Console.WriteLine($"Compiling '{sampleName}' threw: {e.Message}");
+                romInfo = new RomInfo { IsSuccessful = false };
+            }
+            stopwatch.Stop();
+
+            var statistics = romInfo.Statistics;
+            return new SampleResult
+            {
+                Sample = sampleName,
+                Optimized = optimized,
+                IsSuccessful = romInfo.IsSuccessful,
+                RomBytes = statistics.RomBytes,
+                RamBytes = statistics.RamBytes,
+                AssemblerPasses = statistics.AssemblerPasses,
+                MacroCounts = statistics.MacroCounts.ToDictionary(p => p.Key, p => p.Value),
+                PhaseMilliseconds = statistics.PhaseTimes.ToDictionary(p => p.Phase, p => Math.Round(p.Time.TotalMilliseconds, 1)),
+                TotalMilliseconds = Math.Round(stopwatch.Elapsed.TotalMilliseconds, 1)
+            };
+        }
+
+        private static IEnumerable<string> FindMissingMacros(SampleResult result)
+        {
+            if (!result.Optimized || !result.IsSuccessful || !RequiredMacros.TryGetValue(result.Sample, out var required))
+                yield break;
+            foreach (var macro in required.Where(m => !result.MacroCounts.ContainsKey(m)))
+                yield return $"{result.Key}: doesn't use {macro}.";
+        }
+
+        private static IEnumerable<string> FindRegressions(SampleResult baseline, SampleResult current, double threshold, double? timeThreshold)
+        {
+            if (baseline.IsSuccessful && !current.IsSuccessful)
+            {
+                yield return $"{current.Key}: compiled successfully in baseline, now fails.";
+                yield break;
+            }
+            if (!current.IsSuccessful)
+                yield break;
+
+            foreach (var (metric, before, after) in new (string, double, double)[]
+            {
+                (nameof(SampleResult.RomBytes), baseline.RomBytes, current.RomBytes),
+                (nameof(SampleResult.RamBytes), baseline.RamBytes, current.RamBytes),
+                (nameof(SampleResult.TotalMacros), baseline.TotalMacros, current.TotalMacros),
+                (nameof(SampleResult.AssemblerPasses), baseline.AssemblerPasses, current.AssemblerPasses),
+            })
+            {
+                if (IsRegression(before, after, threshold))
+                    yield return $"{current.Key}: {metric} went from {before} to {after}.";
+            }
+
+            if (timeThreshold is double allowedTimeGrowth && IsRegression(baseline.TotalMilliseconds, current.TotalMilliseconds, allowedTimeGrowth))
+                yield return $"{current.Key}: compile time went from {baseline.TotalMilliseconds}ms to {current.TotalMilliseconds}ms.";
+
+            static bool IsRegression(double before, double after, double allowedGrowth)
+                => after > before && after > before * (1 + allowedGrowth);
+        }
+
+        private static string FormatTable(IEnumerable<SampleResult> results, IImmutableDictionary<string, SampleResult> baseline)
+        {
+            var builder = new StringBuilder();
+            builder.AppendLine($"{"Sample",-60} {"ROM",10} {"RAM",8} {"Macros",10} {"Passes",8} {"ms",10}");
+            foreach (var result in results)
+            {
+                baseline.TryGetValue(result.Key, out var b);
+                if (!result.IsSuccessful)
+                {
+                    builder.AppendLine($"{result.Key,-60} {"FAILED",10}");
+                    continue;
+                }
+                builder.AppendLine($"{result.Key,-60} {WithDelta(result.RomBytes, b?.RomBytes),10} {WithDelta(result.RamBytes, b?.RamBytes),8} {WithDelta(result.TotalMacros, b?.TotalMacros),10} {WithDelta(result.AssemblerPasses, b?.AssemblerPasses),8} {result.TotalMilliseconds,10}");
+                builder.AppendLine($"    {string.Join(", ", result.PhaseMilliseconds.Select(p => $"{p.Key}={p.Value}ms"))}");
+            }
+            return builder.ToString();
+
+            static string WithDelta(int value, int? baselineValue)
+                => baselineValue is int b && b != value ? $"{value}({value - b:+0;-0})" : $"{value}";
+        }
+
+        private static string FindRepoRoot()
+        {
+            for (var directory = new DirectoryInfo(AppContext.BaseDirectory); directory != null; directory = directory.Parent)
+            {
+                if (File.Exists(Path.Combine(directory.FullName, "CSharpTo2600.sln")))
+                    return directory.FullName;
+            }
+            return Directory.GetCurrentDirectory();
+        }
+    }
+}
@@ -14,18 +14,23 @@ namespace VCSCompiler
     internal static class AssemblyTemplate
     {
         private sealed record IndentInfo(int DeltaIndent = 0, int? AbsoluteIndent = null);
+        public const int RomStart = 0xF000;
+        public const string RomEndLabelName = "ROM_END";
         private static readonly ILabel StartLabel = new BranchTargetLabel("START");
+        // Marks the end of code and RomData, so ROM usage can be looked up from the assembler's label file.
+        private static readonly ILabel RomEndLabel = new BranchTargetLabel(RomEndLabelName);
 
         public static IEnumerable<IAssemblyEntry> GenerateProgram(
             Function entryPoint,
             ImmutableArray<Function> nonInlineFunctions,
             ImmutableArray<LabelAssign> labelAssignments,
-            ImmutableArray<(RomDataGlobalLabel, ImmutableArray<byte>)> allRomData)
+            ImmutableArray<(RomDataGlobalLabel, ImmutableArray<byte>)> allRomData,
+            ImmutableArray<(ILabel, ImmutableArray<byte>)> mathTables)
         {
             yield return new Comment($"Generated on {DateTime.Now:R}");
             yield return new Blank();
             yield return new CpuOp("6502");
-            yield return new ProgramCounterAssign(0xF000);
+            yield return new ProgramCounterAssign(RomStart);
             yield return new Blank();
             yield return new IncludeOp("vcs.h");
             yield return new IncludeOp("vil.h");
@@ -47,16 +52,32 @@ namespace VCSCompiler
             yield return new Blank();
             foreach (var (label, data) in allRomData)
             {
-                yield return label;
-                foreach (var dataByte in data)
-                    yield return new ByteOp(ImmutableArray.Create(dataByte));
+                foreach (var entry in DataBlock(label, data))
+                    yield return entry;
+            }
+            foreach (var (label, data) in mathTables)
+            {
+                // Indexed reads that cross a page boundary cost an extra cycle, so keep each table within a page.
+                yield return new AlignOp(256);
+                foreach (var entry in DataBlock(label, data))
+                    yield return entry;
             }
+            yield return RomEndLabel;
             yield return new Blank();
             yield return new ProgramCounterAssign(0xFFFC);
             yield return new WordOp(StartLabel);
             yield return new WordOp(StartLabel);
         }
 
+        private static IEnumerable<IAssemblyEntry> DataBlock(ILabel label, ImmutableArray<byte> data)
+        {
+            // Emitting a whole row per .byte keeps large tables from blowing up the size of the .asm and the assembler's line count.
+            const int BytesPerRow = 16;
+            yield return label;
+            for (var i = 0; i < data.Length; i += BytesPerRow)
+                yield return new ByteOp(ImmutableArray.Create(data, i, Math.Min(BytesPerRow, data.Length - i)));
+        }
+
         public static string ProgramToString(IEnumerable<IAssemblyEntry> program, SourceAnnotation annotations)
         {
             const string IndentString = "\t";
@@ -111,6 +132,7 @@ namespace VCSCompiler
                 ProgramCounterAssign pc => $"* = ${pc.Address:X4}",
                 IPseudoOp p => p switch
                 {
+                    AlignOp ao => $".align {ao.Boundary}",
                     BeginBlock => ".block",
                     ByteOp bo => $".byte {string.Join(",", bo.Bytes.Select(b => $"${b:X2}"))}",
                     CpuOp co => $@".cpu ""{co.Architecture}""",
@@ -128,6 +150,7 @@ namespace VCSCompiler
                         byte b => Convert.ToString(b),
                         FormattedByte fb => fb.ToString(),
                         int i => Convert.ToString(i),
+                        ushort u => Convert.ToString(u),
                         _ => throw new ArgumentException($"No support for constant of type {c.Value.GetType()}")
                     },
                     IFunctionCall fc => $"{fc.Name}({string.Join(", ", fc.Parameters.Select(e => GetStringFromEntry(e, method, annotations).Single()))})",
@@ -145,7 +168,8 @@ namespace VCSCompiler
                         PredefinedGlobalLabel pg => pg.Name,
                         ReservedGlobalLabel rg => $"INTERNAL_RESERVED_{rg.Index}",
                         ReturnValueGlobalLabel rv => $"RETVAL_{rv.Method.DeclaringType.NamespaceAndName()}_{rv.Method.SafeName()}",
-                        RomDataGlobalLabel rdgl => $"ROMDATA_{rdgl.GeneratorMethod.DeclaringType.NamespaceAndName()}_{rdgl.GeneratorMethod.SafeName()}",
+                        RomDataFileGlobalLabel rdfl => $"ROMDATA_FILE_{rdfl.Field.DeclaringType.NamespaceAndName()}_{rdfl.Field.Name}",
+                        RomDataGeneratorGlobalLabel rdgl => $"ROMDATA_{rdgl.GeneratorMethod.DeclaringType.NamespaceAndName()}_{rdgl.GeneratorMethod.SafeName()}",
                         ThisPointerGlobalLabel t => $"THIS_PTR_{t.Method.DeclaringType.NamespaceAndName()}_{t.Method.SafeName()}",
                         TypeLabel t => $"TYPE_{t.Type.NamespaceAndName()}",
                         TypeSizeLabel ts => $"SIZE_{ts.Type.NamespaceAndName()}",
@@ -19,7 +19,11 @@ namespace VCSCompiler
         public Auditor GetAuditor(string name, AuditTag tag)
         {
             var auditor = new Auditor(name, tag, GetTicks);
-            Auditors.Add(auditor);
+            // Batch builds request auditors from several threads.
+            lock (Auditors)
+            {
+                Auditors.Add(auditor);
+            }
             return auditor;
         }
         
@@ -176,10 +176,9 @@ namespace VCSCompiler
 			// I'm just doing al=AngleLeft, ar=AngleRight, p=Pipe
 			=> @this.Name.Replace("<", "_al_").Replace(">", "_ar_").Replace("|", "_p_");
 
-		public static dynamic InvokeRomDataGenerator(this Assembly userAssembly, MethodDefinition generator)
+		public static MethodInfo ResolveRomDataGenerator(this Assembly userAssembly, MethodDefinition generator)
 		{
-			var compiledMethod = userAssembly.Modules.Single().ResolveMethod(generator.MetadataToken.ToInt32()) ?? throw new InvalidOperationException($"Failed to lookup RomData generator '{generator.FullName}' in user assembly '{userAssembly}'.");
-			return (dynamic)(compiledMethod.Invoke(null, null) ?? throw new InvalidOperationException($"Return value of RomData generator '{generator.FullName}' was NULL."));
+			return userAssembly.Modules.Single().ResolveMethod(generator.MetadataToken.ToInt32()) as MethodInfo ?? throw new InvalidOperationException($"Failed to lookup RomData generator '{generator.FullName}' in user assembly '{userAssembly}'.");
 		}
 
 		public static string NamespaceAndName(this TypeRef @this) => ((TypeReference)@this).NamespaceAndName();
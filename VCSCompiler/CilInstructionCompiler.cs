@@ -23,11 +23,17 @@ namespace VCSCompiler
 		public static readonly Instruction NopInst = Instruction.Create(OpCodes.Ldstr, "NO INSTRUCTION");
 		private static readonly TypeLabel ByteType = new(BuiltInDefinitions.Byte);
 		private static readonly TypeSizeLabel ByteSize = new(BuiltInDefinitions.Byte);
+		private static readonly TypeLabel UInt16Type = new(BuiltInDefinitions.UInt16);
+		private static readonly TypeSizeLabel UInt16Size = new(BuiltInDefinitions.UInt16);
+		private static readonly TypeLabel Int16Type = new(BuiltInDefinitions.Int16);
+		private static readonly TypeSizeLabel Int16Size = new(BuiltInDefinitions.Int16);
 		private readonly ImmutableDictionary<Code, Func<Instruction, IEnumerable<IAssemblyEntry>>> MethodMap;
 		private readonly MethodDefinition MethodDefinition;
 		private readonly AssemblyPair UserPair;
 		private readonly ImmutableArray<AssemblyDefinition> Assemblies;
 		private readonly Options CompilationOptions;
+		/// <summary>Passed to math macros that can trade ROM for cycles (tables, unrolled loops).</summary>
+		private static Constant SpeedOverSizeConstant => new((byte)(Compiler.Options.MathStrategy == MathStrategy.Speed ? 1 : 0));
 
 		public CilInstructionCompiler(MethodDefinition methodDefinition, AssemblyPair userPair, Options? options = null)
         {
@@ -137,20 +143,23 @@ namespace VCSCompiler
 			byte value = 0;
 			if (instruction.Operand != null)
 			{
-				try
-				{
-					// @TODO - Don't limit to byte, also don't be this verbose.
-					value = Convert.ToByte(instruction.Operand);
-				}
-				catch (OverflowException)
-				{
-					throw new InvalidInstructionException(instruction, $"Constant value '{instruction.Operand}'must fit in a byte!");
-				}
+				// Constants are pushed as the smallest type that holds them, CIL's int32 is never actually needed.
+				var intValue = Convert.ToInt32(instruction.Operand);
+				if (intValue >= byte.MinValue && intValue <= byte.MaxValue)
+					value = (byte)intValue;
+				else if (intValue > byte.MaxValue && intValue <= ushort.MaxValue)
+					return LoadWideConstant(instruction, (ushort)intValue, UInt16Type, UInt16Size);
+				else if (intValue < 0 && intValue >= short.MinValue)
+					return LoadWideConstant(instruction, unchecked((ushort)intValue), Int16Type, Int16Size);
+				else
+					throw new InvalidInstructionException(instruction, $"Constant value '{instruction.Operand}' must fit in 16 bits!");
 			}
 			else
 			{
 				switch (instruction.OpCode.Code)
 				{
+					case Code.Ldc_I4_M1:
+						return LoadWideConstant(instruction, ushort.MaxValue, Int16Type, Int16Size);
 					case Code.Ldc_I4_0:
 						return LoadConstant(instruction, 0);
 					case Code.Ldc_I4_1:
@@ -179,6 +188,11 @@ namespace VCSCompiler
 			yield return new PushConstant(instruction, new Constant(value), ByteType, ByteSize);
 		}
 
+		private IEnumerable<IAssemblyEntry> LoadWideConstant(Instruction instruction, ushort value, TypeLabel type, TypeSizeLabel size)
+		{
+			yield return new PushConstant(instruction, new Constant(value), type, size);
+		}
+
 		private IEnumerable<IAssemblyEntry> LoadLocal(Instruction instruction)
         {
 			switch (instruction.OpCode.Code)
@@ -230,10 +244,15 @@ namespace VCSCompiler
 			yield return new AddFromStack(instruction, new(1), new(1), new(0), new(0));
         }
 
+		private IEnumerable<IAssemblyEntry> And(Instruction instruction)
+        {
+			yield return new AndFromStack(instruction, new(1), new(1), new(0), new(0));
+        }
+
 		private IEnumerable<IAssemblyEntry> Blt(Instruction instruction)
         {
 			var targetInstruction = (Instruction)instruction.Operand;
-			yield return new BranchIfLessThanFromStack(instruction, new InstructionLabel(targetInstruction));
+			yield return new BranchIfLessThanFromStack(instruction, new(1), new(1), new(0), new(0), new InstructionLabel(targetInstruction));
         }
 
 		private IEnumerable<IAssemblyEntry> Blt_S(Instruction instruction) => Blt(instruction);
@@ -313,11 +332,11 @@ namespace VCSCompiler
 					"Y" => 2,
 					_ => throw new InvalidOperationException($"Unknown register '{overrideLoadToRegister.Register}'")
                 };
-				yield return new PopToRegister(instruction, new(register), new(0));
+				yield return new PopToRegister(instruction, new(register), new(0), new(0));
             }
 			else if (method.TryGetFrameworkAttribute<ReplaceWithEntryAttribute>(out var replaceWithMacro))
             {
-				yield return (IAssemblyEntry)(Activator.CreateInstance(replaceWithMacro.Type, instruction) 
+				yield return (IAssemblyEntry)(Activator.CreateInstance(replaceWithMacro.Type, ReplacementEntryArguments(instruction, replaceWithMacro.Type, arity)) 
 					?? throw new InvalidOperationException($"Failed to replace call to [{nameof(ReplaceWithEntryAttribute)}]-attributed method '{method}' with {nameof(IMacroCall)} type {replaceWithMacro.Type}"));
             }
 			else
@@ -370,9 +389,14 @@ namespace VCSCompiler
 			yield return new CompareEqualToFromStack(instruction, new(1), new(1), new(0), new(0));
         }
 
+		private IEnumerable<IAssemblyEntry> Cgt(Instruction instruction)
+        {
+			yield return new CompareGreaterThanFromStack(instruction, new(1), new(1), new(0), new(0));
+        }
+
 		private IEnumerable<IAssemblyEntry> Clt(Instruction instruction)
         {
-			yield return new CompareLessThanFromStack(instruction, new(0), new(0), new(1), new(1));
+			yield return new CompareLessThanFromStack(instruction, new(1), new(1), new(0), new(0));
         }
 
 		private IEnumerable<IAssemblyEntry> Conv_I(Instruction instruction)
@@ -394,6 +418,22 @@ namespace VCSCompiler
 			yield break;
         }
 
+		private IEnumerable<IAssemblyEntry> Conv_U2(Instruction instruction)
+        {
+			// Like conv.u1, the value already has the size it'll be stored with. Storing a byte into a 16-bit
+			// global zero-extends it, storing a 16-bit value into a byte global truncates it.
+			yield break;
+        }
+
+		private IEnumerable<IAssemblyEntry> Conv_I2(Instruction instruction) => Conv_U2(instruction);
+
+		private IEnumerable<IAssemblyEntry> Div(Instruction instruction)
+        {
+			yield return new DivideFromStack(instruction, new(1), new(1), new(0), new(0), SpeedOverSizeConstant);
+        }
+
+		private IEnumerable<IAssemblyEntry> Div_Un(Instruction instruction) => Div(instruction);
+
 		private IEnumerable<IAssemblyEntry> Dup(Instruction instruction)
         {
 			yield return new Duplicate(instruction, new(0), new(0));
@@ -414,6 +454,9 @@ namespace VCSCompiler
 		private IEnumerable<IAssemblyEntry> Ldc_I4_S(Instruction instruction)
 			=> LoadConstant(instruction);
 
+		private IEnumerable<IAssemblyEntry> Ldc_I4_M1(Instruction instruction)
+			=> LoadConstant(instruction);
+
 		private IEnumerable<IAssemblyEntry> Ldfld(Instruction instruction)
         {
 			var field = (FieldReference)instruction.Operand;
@@ -479,6 +522,11 @@ namespace VCSCompiler
 			yield return new LoadString(instruction);
         }
 
+		private IEnumerable<IAssemblyEntry> Mul(Instruction instruction)
+        {
+			yield return new MultiplyFromStack(instruction, new(1), new(1), new(0), new(0), SpeedOverSizeConstant);
+        }
+
 		private IEnumerable<IAssemblyEntry> Neg(Instruction instruction)
         {
 			yield return new NegateFromStack(instruction, new StackTypeArrayAccess(0), new StackSizeArrayAccess(0));
@@ -499,6 +547,13 @@ namespace VCSCompiler
 			yield return new OrFromStack(instruction, new(1), new(1), new(0), new(0));
         }
 
+		private IEnumerable<IAssemblyEntry> Rem(Instruction instruction)
+        {
+			yield return new RemainderFromStack(instruction, new(1), new(1), new(0), new(0), SpeedOverSizeConstant);
+        }
+
+		private IEnumerable<IAssemblyEntry> Rem_Un(Instruction instruction) => Rem(instruction);
+
 		private IEnumerable<IAssemblyEntry> Ret(Instruction instruction)
         {
 			if (MethodDefinition.ReturnType.FullName != typeof(void).FullName)
@@ -508,6 +563,19 @@ namespace VCSCompiler
 			yield return new ReturnFromMethod(instruction);
         }
 
+		private IEnumerable<IAssemblyEntry> Shl(Instruction instruction)
+        {
+			yield return new ShiftLeftFromStack(instruction, new(1), new(1), new(0), new(0));
+        }
+
+		private IEnumerable<IAssemblyEntry> Shr(Instruction instruction)
+        {
+			// Only unsigned types are supported, so arithmetic and logical right shifts are the same.
+			yield return new ShiftRightFromStack(instruction, new(1), new(1), new(0), new(0));
+        }
+
+		private IEnumerable<IAssemblyEntry> Shr_Un(Instruction instruction) => Shr(instruction);
+
 		private IEnumerable<IAssemblyEntry> Stfld(Instruction instruction)
         {
 			var field = (FieldReference)instruction.Operand;
@@ -541,6 +609,25 @@ namespace VCSCompiler
 
 		private IEnumerable<IAssemblyEntry> Unsupported(Instruction instruction) => throw new UnsupportedOpCodeException(instruction.OpCode);
 
+		/// <summary>
+		/// Builds the constructor arguments for a [<see cref="ReplaceWithEntryAttribute"/>] entry. Operator macros get the
+		/// types/sizes of the method's arguments, e.g. the first of 2 operands is STACK_TYPEOF[1].
+		/// </summary>
+		private static object[] ReplacementEntryArguments(Instruction instruction, Type entryType, int arity)
+        {
+			var parameters = entryType.GetConstructors().Single().GetParameters();
+			var typeIndex = arity - 1;
+			var sizeIndex = arity - 1;
+			return parameters.Select(p => p.ParameterType switch
+			{
+				var t when t == typeof(Instruction) => instruction,
+				var t when t == typeof(IEnumerable<Instruction>) => new[] { instruction },
+				var t when t == typeof(StackTypeArrayAccess) => new StackTypeArrayAccess(typeIndex--),
+				var t when t == typeof(StackSizeArrayAccess) => (object)new StackSizeArrayAccess(sizeIndex--),
+				_ => throw new InvalidOperationException($"Can't replace a call with {entryType.Name}, don't know what to pass for its '{p.Name}' parameter.")
+			}).ToArray();
+        }
+
 		private bool IsBranchInstruction(Instruction instruction)
         {
 			var branchInstructions = new[]
@@ -3,7 +3,9 @@ using Microsoft.CodeAnalysis;
 using Microsoft.CodeAnalysis.CSharp;
 using Microsoft.CodeAnalysis.Text;
 using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
+using System.Collections.Immutable;
 using System.IO;
 using System.Linq;
 using System.Reflection;
@@ -19,10 +21,19 @@ namespace VCSCompiler
 		private static readonly MetadataReference MsCorLibReference = MetadataReference.CreateFromFile(Assembly.Load(new AssemblyName("mscorlib, Version=4.0.0.0, Culture=neutral, PublicKeyToken=7cec85d7bea7798e")).Location);
 		private static readonly MetadataReference FrameworkReference = MetadataReference.CreateFromFile(typeof(VCSFramework.IAssemblyEntry).GetTypeInfo().Assembly.Location);
 		private static readonly MetadataReference[] MetadataReferences = new[] { RuntimeReference, CoreLibReference, MsCorLibReference, FrameworkReference };
+		// Batch builds often compile the same files several times with different options. Keyed by path and symbols, so there's
+		// at most one entry per user source file and variant. An entry is replaced when its file's contents change.
+		private static readonly ConcurrentDictionary<(string Path, string Symbols), (string Text, SyntaxTree Tree)> SyntaxTreeCache = new();
 
-		public static CSharpCompilation CreateFromFilePaths(IEnumerable<string> filePaths, string? mainTypeName)
+		/// <summary>Forces the shared metadata references to load.</summary>
+		public static void WarmUp() => _ = MetadataReferences.Length;
+
+		/// <param name="generatedFilePath">Template-generated source, which is unique to each compilation and so never cached.</param>
+		public static CSharpCompilation CreateFromFilePaths(IEnumerable<string> filePaths, string? mainTypeName, ImmutableArray<string> preprocessorSymbols, string? generatedFilePath = null)
 		{
-			var syntaxTrees = filePaths.Select(Parse);
+			var syntaxTrees = filePaths.Select(path => ParseCached(path, preprocessorSymbols));
+			if (generatedFilePath != null)
+				syntaxTrees = syntaxTrees.Append(Parse(generatedFilePath, File.ReadAllText(generatedFilePath), preprocessorSymbols));
 
 			var outputType = mainTypeName != null ? OutputKind.ConsoleApplication : OutputKind.DynamicallyLinkedLibrary;
 			var options = new CSharpCompilationOptions(outputType, allowUnsafe: true, optimizationLevel: OptimizationLevel.Release, mainTypeName: mainTypeName);
@@ -48,11 +59,22 @@ namespace VCSCompiler
 			return compilation;
 		}
 
-		private static SyntaxTree Parse(string filename)
+		private static SyntaxTree ParseCached(string filename, ImmutableArray<string> preprocessorSymbols)
 		{
 			var fileText = File.ReadAllText(filename);
+			var key = (Path.GetFullPath(filename), string.Join(";", preprocessorSymbols));
+			if (SyntaxTreeCache.TryGetValue(key, out var cached) && cached.Text == fileText)
+				return cached.Tree;
+
+			var syntaxTree = Parse(filename, fileText, preprocessorSymbols);
+			SyntaxTreeCache[key] = (fileText, syntaxTree);
+			return syntaxTree;
+		}
+
+		private static SyntaxTree Parse(string filename, string fileText, ImmutableArray<string> preprocessorSymbols)
+		{
 			var sourceText = SourceText.From(fileText, Encoding.UTF8); // Need to specify encoding in order to embed PDB.
-			return SyntaxFactory.ParseSyntaxTree(sourceText, new CSharpParseOptions(LanguageVersion.Latest), filename);
+			return SyntaxFactory.ParseSyntaxTree(sourceText, new CSharpParseOptions(LanguageVersion.Latest, preprocessorSymbols: preprocessorSymbols), filename);
 		}
 	}
 }
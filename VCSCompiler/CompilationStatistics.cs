@@ -0,0 +1,43 @@
+#nullable enable
+using System;
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.Diagnostics;
+
+namespace VCSCompiler
+{
+    /// <summary>
+    /// Measurements taken while compiling a single program. Used to track how compiler changes
+    /// affect the size and build time of the generated ROM.
+    /// </summary>
+    public sealed record CompilationStatistics
+    {
+        /// <summary>Bytes of ROM used by code and RomData, excluding the reset/interrupt vectors.</summary>
+        public int RomBytes { get; init; }
+        /// <summary>Bytes of zero-page RAM assigned to globals, locals, arguments, etc. Does not include the hardware stack.</summary>
+        public int RamBytes { get; init; }
+        public int AssemblerPasses { get; init; }
+        /// <summary>Number of invocations of each VIL macro, keyed by macro name.</summary>
+        public ImmutableDictionary<string, int> MacroCounts { get; init; } = ImmutableDictionary<string, int>.Empty;
+        /// <summary>Number of occurrences of each run of adjacent macro calls, keyed by shape. See <see cref="MacroSequences"/> for the format.</summary>
+        public ImmutableDictionary<string, int> MacroSequenceCounts { get; init; } = ImmutableDictionary<string, int>.Empty;
+        /// <summary>Wall time spent in each phase of compilation, in the order the phases ran.</summary>
+        public ImmutableArray<(string Phase, TimeSpan Time)> PhaseTimes { get; init; } = ImmutableArray<(string, TimeSpan)>.Empty;
+    }
+
+    /// <summary>Accumulates wall time for each named phase of a compilation.</summary>
+    internal sealed class PhaseTimer
+    {
+        private readonly List<(string Phase, TimeSpan Time)> Phases = new();
+
+        public ImmutableArray<(string Phase, TimeSpan Time)> Results => Phases.ToImmutableArray();
+
+        public T Time<T>(string phase, Func<T> action)
+        {
+            var stopwatch = Stopwatch.StartNew();
+            var result = action();
+            Phases.Add((phase, stopwatch.Elapsed));
+            return result;
+        }
+    }
+}
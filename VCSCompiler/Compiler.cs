@@ -10,19 +10,23 @@ using System.IO;
 using System.Linq;
 using System.Reflection;
 using System.Runtime.CompilerServices;
-using System.Runtime.InteropServices;
 using System.Runtime.Loader;
+using System.Text.RegularExpressions;
 using VCSFramework;
 using VCSFramework.Templates;
 
 namespace VCSCompiler
 {
-    internal sealed record AssemblyPair(Assembly Assembly, AssemblyDefinition Definition);
+    internal sealed record AssemblyPair(Assembly Assembly, AssemblyDefinition Definition, CSharpCompilation Compilation);
 
     public sealed class Compiler
     {
         private readonly AssemblyPair UserPair;
+        // Batch builds run several compilations at once, each on its own thread.
+        [ThreadStatic]
         private static CompilerOptions? _Options;
+        // 6502.Net keeps global state and we capture its output by redirecting Console, so only one assembly at a time.
+        private static readonly object AssemblerLock = new();
         internal static CompilerOptions Options
         {
             get
@@ -39,11 +43,40 @@ namespace VCSCompiler
             _Options = options;
         }
 
+        /// <summary>
+        /// Loads state that's shared between compilations (framework metadata references and assemblies, the macro register effects
+        /// read from vil.h) up front. The assembler still parses vil.h itself for every ROM.
+        /// Optional, but lets a batch build pay for it once before starting concurrent compilations.
+        /// </summary>
+        public static void WarmUp()
+        {
+            CompilationCreator.WarmUp();
+            _ = BuiltInDefinitions.Types.Count();
+            MacroRegisterEffects.WarmUp();
+        }
+
         public static RomInfo CompileFromFile(string sourcePath, CompilerOptions options)
+            => CompileFromFiles(new[] { sourcePath }, options);
+
+        public static RomInfo CompileFromFiles(IEnumerable<string> sourcePaths, CompilerOptions options)
+        {
+            try
+            {
+                return Compile(sourcePaths, options);
+            }
+            finally
+            {
+                // Batch builds reuse threads, don't let a failed compilation's options leak into the next one.
+                _Options = null;
+            }
+        }
+
+        private static RomInfo Compile(IEnumerable<string> sourcePaths, CompilerOptions options)
         {
             /**
              * Assumptions:
-             * 1) This program is single threaded, there will never be a justification to multi-thread it.
+             * 1) A single compilation is single threaded. Batch builds run several compilations at once, so any state
+             *  specific to one compilation must not be shared (see Options).
              * 2) CIL will be processed instead of C#, since it's much easier to translate to 6502 ASM than a syntax tree.
              * 
              * Problems:
@@ -70,96 +103,105 @@ namespace VCSCompiler
              * 6) In the end, the generated .asm may look like an intermediate representation, with lots of parameterized macro
              *  calls defining common tasks, rather than forcing the compiler to implement them and introduce more ASM-rewriting.
              */
-            var userPair = CreateAssemblyPair(new[] { sourcePath }.ToImmutableArray());
+            var timer = new PhaseTimer();
+            var userPair = timer.Time("Roslyn", () => CreateAssemblyPair(sourcePaths.ToImmutableArray(), options));
 
-            var compiler = new Compiler(userPair, options);
-            var entryPointBody = MethodCompiler.Compile(userPair.Definition.EntryPoint, userPair, false, true, new CilInstructionCompiler.Options
+            try
             {
-                InlineAllCalls = true
-            });
-            // @TODO - Control should never return from the entry point. For RawTemplate, this means ensuring the _user_'s entry point
-            // never returns. For StandardTemplate, _its_ entry point should never return.
-
-            var allFunctions = compiler.RecursiveCompileAllFunctions(userPair, entryPointBody);
-            var allLabelAssignments = CreateLabelAssignments(allFunctions.Prepend(entryPointBody).ToImmutableArray(), userPair);
-            var allRomData = allFunctions.Prepend(entryPointBody)
-                .SelectMany(GetAllMacroParameters)
-                .OfType<RomDataGlobalLabel>()
-                .Select(label =>
+                var compiler = new Compiler(userPair, options);
+                var entryPointBody = timer.Time("Entry point", () => MethodCompiler.Compile(userPair.Definition.EntryPoint, userPair, false, true, new CilInstructionCompiler.Options
+                {
+                    InlineAllCalls = true
+                }));
+                // @TODO - Control should never return from the entry point. For RawTemplate, this means ensuring the _user_'s entry point
+                // never returns. For StandardTemplate, _its_ entry point should never return.
+
+                var allFunctions = timer.Time("Functions", () => compiler.RecursiveCompileAllFunctions(userPair, entryPointBody));
+                var ramBytes = 0;
+                var allLabelAssignments = timer.Time("Labels", () => CreateLabelAssignments(allFunctions.Prepend(entryPointBody).ToImmutableArray(), userPair, out ramBytes));
+                var allRomData = timer.Time("RomData", () => allFunctions.Prepend(entryPointBody)
+                    .SelectMany(GetAllMacroParameters)
+                    .OfType<RomDataGlobalLabel>()
+                    .Distinct()
+                    .Select(label => (label, RomDataUtilities.BytesOf(userPair, label)))
+                    .ToImmutableArray());
+                var mathTables = MathTables.GetRequiredTables(allFunctions.Prepend(entryPointBody).SelectMany(GetAllMacroCalls));
+                var fullProgram = AssemblyTemplate.GenerateProgram(entryPointBody, allFunctions, allLabelAssignments, allRomData, mathTables);
+
+                //var assemblyWriter = new AssemblyWriter(labelMap.FunctionToBody.Add(userAssemblyDefinition.MainModule.EntryPoint, entryPointBody), labelMap, options.SourceAnnotations);
+
+                var qq = timer.Time("Emit", () => AssemblyTemplate.ProgramToString(fullProgram, SourceAnnotation.Both));
+                var romInfo = timer.Time("Assembler", () => Assemble(qq, options.OutputPath, options.Log));
+                romInfo = romInfo with
                 {
-                    // @TODO - What do we do for 0 elements?
-                    var romData = ImmutableArray.ToImmutableArray(userPair.Assembly.InvokeRomDataGenerator(label.GeneratorMethod));
-                    var elementSize = Marshal.SizeOf(Enumerable.First(romData));
-                    var byteBuffer = new byte[romData.Length * elementSize];
-                    var byteIndex = 0;
-                    foreach (var element in romData)
+                    Statistics = romInfo.Statistics with
                     {
-                        var ptr = Marshal.AllocHGlobal(elementSize);
-                        Marshal.StructureToPtr(element, ptr, false);
-                        Marshal.Copy(ptr, byteBuffer, byteIndex, elementSize);
-                        byteIndex += elementSize;
-                        Marshal.FreeHGlobal(ptr);
+                        RamBytes = ramBytes,
+                        MacroCounts = allFunctions.Prepend(entryPointBody)
+                            .SelectMany(GetAllMacroCalls)
+                            .GroupBy(m => m.Name)
+                            .ToImmutableDictionary(g => g.Key, g => g.Count()),
+                        MacroSequenceCounts = MacroSequences.Count(allFunctions.Prepend(entryPointBody)),
+                        PhaseTimes = timer.Results
                     }
-                    return (label, byteBuffer.ToImmutableArray());
-                })
-                .ToImmutableArray();
-            var fullProgram = AssemblyTemplate.GenerateProgram(entryPointBody, allFunctions, allLabelAssignments, allRomData);
-
-            //var assemblyWriter = new AssemblyWriter(labelMap.FunctionToBody.Add(userAssemblyDefinition.MainModule.EntryPoint, entryPointBody), labelMap, options.SourceAnnotations);
-
-            var qq = AssemblyTemplate.ProgramToString(fullProgram, SourceAnnotation.Both);
-            var romInfo = Assemble(qq, options.OutputPath);
+                };
 
-            if (options.TextEditorPath != null && romInfo.AssemblyPath != null)
-            {
-                try
+                if (options.TextEditorPath != null && romInfo.AssemblyPath != null)
                 {
-                    Process.Start(new ProcessStartInfo
+                    try
                     {
-                        FileName = options.TextEditorPath,
-                        Arguments = romInfo.AssemblyPath
-                    });
-                }
-                catch (Exception e)
-                {
-                    Console.WriteLine($"Failed to open text editor at {options.TextEditorPath} with ASM file {romInfo.AssemblyPath} because: {e.Message}");
+                        Process.Start(new ProcessStartInfo
+                        {
+                            FileName = options.TextEditorPath,
+                            Arguments = romInfo.AssemblyPath
+                        });
+                    }
+                    catch (Exception e)
+                    {
+                        options.Log.WriteLine($"Failed to open text editor at {options.TextEditorPath} with ASM file {romInfo.AssemblyPath} because: {e.Message}");
+                    }
                 }
-            }
 
-            if (options.EmulatorPath != null && romInfo.RomPath != null)
-            {
-                try
+                if (options.EmulatorPath != null && romInfo.RomPath != null)
                 {
-                    Process.Start(new ProcessStartInfo
+                    try
                     {
-                        FileName = options.EmulatorPath,
-                        Arguments = romInfo.RomPath
-                    });
-                }
-                catch (Exception e)
-                {
-                    Console.WriteLine($"Failed to open emulator at {options.EmulatorPath} with BIN file {romInfo.RomPath} because: {e.Message}");
+                        Process.Start(new ProcessStartInfo
+                        {
+                            FileName = options.EmulatorPath,
+                            Arguments = romInfo.RomPath
+                        });
+                    }
+                    catch (Exception e)
+                    {
+                        options.Log.WriteLine($"Failed to open emulator at {options.EmulatorPath} with BIN file {romInfo.RomPath} because: {e.Message}");
+                    }
                 }
-            }
 
-            var final = romInfo.IsSuccessful ? "Compilation succeeded." : "Compilation failed";
-            Console.WriteLine(final);
-            _Options = null;
-            return romInfo;
+                var final = romInfo.IsSuccessful ? "Compilation succeeded." : "Compilation failed";
+                options.Log.WriteLine(final);
+                return romInfo;
+            }
+            finally
+            {
+                // The user assembly is loaded into a collectible context, so a batch build doesn't keep every ROM's assembly loaded.
+                AssemblyLoadContext.GetLoadContext(userPair.Assembly)!.Unload();
+            }
 
-            static RomInfo Assemble(string assembly, string? outputPath)
+            static RomInfo Assemble(string assembly, string? outputPath, TextWriter log)
             {
                 // @TODO - Should probably delete these?? If there's 65K temp files it'll fail.
                 var binPath = outputPath ?? Path.GetTempFileName();
                 var asmPath = outputPath != null ? Path.ChangeExtension(outputPath, "asm") : Path.GetTempFileName();
                 var listPath = outputPath != null ? Path.ChangeExtension(outputPath, "lst") : Path.GetTempFileName();
+                var labelPath = outputPath != null ? Path.ChangeExtension(outputPath, "lbl") : Path.GetTempFileName();
 
                 File.WriteAllText(asmPath, assembly);
 
                 var assemblerArgs = new[]
                 {
-                    //"-l",
-                    //Path.Combine(Path.GetDirectoryName(asmPath)!, "labeltest.asm"),
+                    "-l",
+                    labelPath,
                     asmPath,
                     "-o",
                     binPath,
@@ -168,25 +210,29 @@ namespace VCSCompiler
                     "--format=flat"
                 };
 
-                using var stdoutStream = new MemoryStream();
-                using var writer = new StreamWriter(stdoutStream) { AutoFlush = true };
-                Console.SetOut(writer);
-                Console.SetError(writer);
-
-                // @TODO - Sometimes the assembler can get into an infinite error loop and never return. We should have a timeout.
-                Core6502DotNet.Core6502DotNet.Main(assemblerArgs);
-
-                Console.SetOut(new StreamWriter(Console.OpenStandardOutput()) { AutoFlush = true });
-                Console.SetError(new StreamWriter(Console.OpenStandardError()) { AutoFlush = true });
-                stdoutStream.Position = 0;
-                using var reader = new StreamReader(stdoutStream);
-                var stdoutText = reader.ReadToEnd();
-                Console.WriteLine("Assembler output:");
-                Console.WriteLine(stdoutText);
+                string stdoutText;
+                lock (AssemblerLock)
+                {
+                    using var stdoutStream = new MemoryStream();
+                    using var writer = new StreamWriter(stdoutStream) { AutoFlush = true };
+                    Console.SetOut(writer);
+                    Console.SetError(writer);
+
+                    // @TODO - Sometimes the assembler can get into an infinite error loop and never return. We should have a timeout.
+                    Core6502DotNet.Core6502DotNet.Main(assemblerArgs);
+
+                    Console.SetOut(new StreamWriter(Console.OpenStandardOutput()) { AutoFlush = true });
+                    Console.SetError(new StreamWriter(Console.OpenStandardError()) { AutoFlush = true });
+                    stdoutStream.Position = 0;
+                    using var reader = new StreamReader(stdoutStream);
+                    stdoutText = reader.ReadToEnd();
+                }
+                log.WriteLine("Assembler output:");
+                log.WriteLine(stdoutText);
 
                 if (!stdoutText.Contains("Assembly completed successfully."))
                 {
-                    Console.WriteLine("Assembly failed, there is probably an internal problem with the code that the compiler is generating.");
+                    log.WriteLine("Assembly failed, there is probably an internal problem with the code that the compiler is generating.");
                     return new RomInfo
                     {
                         IsSuccessful = false,
@@ -194,24 +240,44 @@ namespace VCSCompiler
                     };
                 }
 
-                Console.WriteLine("Assembly was successful.");
+                log.WriteLine("Assembly was successful.");
                 return new RomInfo
                 {
                     IsSuccessful = true,
                     // @TODO - Don't emit if we used temp files?
                     AssemblyPath = asmPath,
                     RomPath = binPath,
-                    ListPath = listPath
+                    ListPath = listPath,
+                    Statistics = new CompilationStatistics
+                    {
+                        RomBytes = GetRomBytes(labelPath),
+                        AssemblerPasses = GetAssemblerPasses(stdoutText)
+                    }
                 };
             }
+
+            static int GetAssemblerPasses(string assemblerOutput)
+            {
+                var match = Regex.Match(assemblerOutput, @"^Passes: (\d+)", RegexOptions.Multiline);
+                return match.Success ? int.Parse(match.Groups[1].Value) : 0;
+            }
+
+            static int GetRomBytes(string labelPath)
+            {
+                // Label file lines look like: "rom_end                           = 61500 ($f03c)", the assembler lowercases names.
+                var romEnd = File.ReadLines(labelPath)
+                    .Select(line => Regex.Match(line, $@"^{AssemblyTemplate.RomEndLabelName}\s+= (\d+)", RegexOptions.IgnoreCase))
+                    .FirstOrDefault(m => m.Success);
+                return romEnd != null ? int.Parse(romEnd.Groups[1].Value) - AssemblyTemplate.RomStart : 0;
+            }
         }
 
-        private static AssemblyPair CreateAssemblyPair(ImmutableArray<string> sourcePaths)
+        private static AssemblyPair CreateAssemblyPair(ImmutableArray<string> sourcePaths, CompilerOptions options)
         {
             // First we compile without the generated template so we can find what type to use.
             // Then we compile with the generated template and return the AssemblyDefinition containing that and the user types.
-            var firstCompilation = CompilationCreator.CreateFromFilePaths(sourcePaths, null);
-            GetAssemblyDefinition(firstCompilation, out var firstAssemblyStream);
+            var firstCompilation = CompilationCreator.CreateFromFilePaths(sourcePaths, null, options.PreprocessorSymbols);
+            GetAssemblyDefinition(firstCompilation, options.Log, out var firstAssemblyStream);
             var loadContext = new AssemblyLoadContext(null, true);
             var firstAssembly = loadContext.LoadFromStream(firstAssemblyStream!);
             firstAssemblyStream.Dispose();
@@ -237,16 +303,18 @@ namespace VCSCompiler
             loadContext.Unload();
 
             var generatedSourceText = template.GenerateSourceText();
-            var generatedSourcePath = Path.Combine(Path.GetTempPath(), $"{template.GeneratedTypeName}.generated.cs");
+            // Thread ID keeps concurrent batch compilations from overwriting each other's generated source.
+            var generatedSourcePath = Path.Combine(Path.GetTempPath(), $"{template.GeneratedTypeName}.{Environment.CurrentManagedThreadId}.generated.cs");
             File.WriteAllText(generatedSourcePath, generatedSourceText);
 
-            var finalCompilation = CompilationCreator.CreateFromFilePaths(sourcePaths.Append(generatedSourcePath), template.GeneratedTypeName);
-            var definition = GetAssemblyDefinition(finalCompilation, out var finalAssemblyStream);
-            var finalAssembly = new AssemblyLoadContext(null, false).LoadFromStream(finalAssemblyStream);
-            return new AssemblyPair(finalAssembly, definition);
+            var finalCompilation = CompilationCreator.CreateFromFilePaths(sourcePaths, template.GeneratedTypeName, options.PreprocessorSymbols, generatedSourcePath);
+            var definition = GetAssemblyDefinition(finalCompilation, options.Log, out var finalAssemblyStream);
+            // Unloaded once the ROM is compiled, see Compile.
+            var finalAssembly = new AssemblyLoadContext(null, true).LoadFromStream(finalAssemblyStream);
+            return new AssemblyPair(finalAssembly, definition, finalCompilation);
         }
 
-        private static AssemblyDefinition GetAssemblyDefinition(CSharpCompilation compilation, out MemoryStream assemblyStream)
+        private static AssemblyDefinition GetAssemblyDefinition(CSharpCompilation compilation, TextWriter log, out MemoryStream assemblyStream)
         {
             assemblyStream = new MemoryStream();
             var emitOptions = new EmitOptions(debugInformationFormat: DebugInformationFormat.Embedded);
@@ -255,7 +323,7 @@ namespace VCSCompiler
             {
                 foreach (var diagnostic in result.Diagnostics)
                 {
-                    Console.WriteLine(diagnostic.ToString());
+                    log.WriteLine(diagnostic.ToString());
                 }
                 throw new FatalCompilationException("Failed to emit compiled assembly.");
             }
@@ -287,7 +355,7 @@ namespace VCSCompiler
             }
         }
 
-        private static ImmutableArray<LabelAssign> CreateLabelAssignments(ImmutableArray<Function> functions, AssemblyPair userPair)
+        private static ImmutableArray<LabelAssign> CreateLabelAssignments(ImmutableArray<Function> functions, AssemblyPair userPair, out int ramBytes)
         {
             // Determines size of 'this' pointers for methods. Calling an instance method on an object in RAM vs ROM requires different sizes.
             var allRomData = functions.SelectMany(GetAllMacroParameters).OfType<RomDataGlobalLabel>().Distinct().ToImmutableArray();
@@ -311,7 +379,7 @@ namespace VCSCompiler
                             return new LabelAssign(l, new PointerSizeLabel(true));
 
                         if (allRomData.Any(romDataLabel
-                            => new TypeRef(((GenericInstanceType)romDataLabel.GeneratorMethod.Method.ReturnType).GenericArguments.Single()) == new TypeRef(methodDef.DeclaringType)))
+                            => romDataLabel.ElementType == new TypeRef(methodDef.DeclaringType)))
                             return new LabelAssign(l, new PointerSizeLabel(false));
                         return new LabelAssign(l, new PointerSizeLabel(true));
                     case GlobalFieldLabel:
@@ -380,13 +448,17 @@ namespace VCSCompiler
                     PointerTypeLabel ptl => ptl.ReferentType,
                     _ => throw new NotImplementedException($"Don't know how to get {nameof(TypeRef)} from {l.GetType().Name}")
                 })
+                // vil.h functions refer to the built-in types directly, so they always need labels.
+                .Prepend(BuiltInDefinitions.Fixed8_8).Prepend(BuiltInDefinitions.Int16).Prepend(BuiltInDefinitions.UInt16)
                 .Prepend(BuiltInDefinitions.Nothing).Prepend(BuiltInDefinitions.Bool).Prepend(BuiltInDefinitions.Byte)
                 .Distinct()
                 .ToImmutableArray();
             var allPairedTypes = allReferencedTypes.Select(t => (new LabelAssign(new TypeLabel(t), new Constant((byte)typeId++)), new LabelAssign(new PointerTypeLabel(t), new Constant((byte)typeId++))));
 
             var allTypeSizes = functions.SelectMany(GetAllMacroParameters).OfType<TypeSizeLabel>()
-                .Select(l => l.Type).Prepend(BuiltInDefinitions.Nothing).Prepend(BuiltInDefinitions.Bool).Prepend(BuiltInDefinitions.Byte).Distinct()
+                .Select(l => l.Type)
+                .Prepend(BuiltInDefinitions.Fixed8_8).Prepend(BuiltInDefinitions.Int16).Prepend(BuiltInDefinitions.UInt16)
+                .Prepend(BuiltInDefinitions.Nothing).Prepend(BuiltInDefinitions.Bool).Prepend(BuiltInDefinitions.Byte).Distinct()
                 .Select(t => new LabelAssign(new TypeSizeLabel(t), new Constant((byte)TypeData.Of(t, userPair.Definition).Size)));
 
             var allLabelAssignments = new List<LabelAssign>();
@@ -411,6 +483,7 @@ namespace VCSCompiler
 
             allLabelAssignments.AddRange(reserved);
             allLabelAssignments.AddRange(otherGlobals);
+            ramBytes = start - 0x80;
             foreach (var pair in allPairedTypes)
             {
                 allLabelAssignments.Add(pair.Item1);
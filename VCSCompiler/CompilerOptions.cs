@@ -1,4 +1,7 @@
 ﻿#nullable enable
+using System;
+using System.Collections.Immutable;
+using System.IO;
 using VCSFramework;
 
 namespace VCSCompiler
@@ -10,8 +13,23 @@ namespace VCSCompiler
         public string? TextEditorPath { get; init; }
         public Region? Region { get; init; } // @TODO
         public bool DisableOptimizations { get; init; }
+        /// <summary>Skips only the generated rules in Optimizations.Superoptimized.cs. Used by VILSuperoptimizer when regenerating them.</summary>
+        public bool DisableSuperoptimizations { get; init; }
         public bool FailOnStackOperations { get; init; } // @TODO
         public SourceAnnotation SourceAnnotations { get; init; } = SourceAnnotation.CSharp;
+        public MathStrategy MathStrategy { get; init; } = MathStrategy.Size;
+        /// <summary>
+        /// Directory to cache RomData generator output in, so unchanged generators don't need to run on every build.
+        /// If null, output is only cached for the lifetime of the process.
+        /// </summary>
+        public string? RomDataCachePath { get; init; }
+        /// <summary>Symbols defined when parsing the C# source, for building variants (e.g. regions, features) of one program.</summary>
+        public ImmutableArray<string> PreprocessorSymbols { get; init; } = ImmutableArray<string>.Empty;
+        /// <summary>
+        /// Where compiler and assembler messages are written. Batch builds give each compilation its own writer so
+        /// concurrent output doesn't interleave.
+        /// </summary>
+        public TextWriter Log { get; init; } = Console.Out;
     }
 
     public enum SourceAnnotation
@@ -21,4 +39,16 @@ namespace VCSCompiler
         CIL,
         Both
     }
+
+    /// <summary>
+    /// How multiplication and division with two non-constant operands should be lowered.
+    /// Operations with a constant operand are always lowered to shifts/adds regardless of this.
+    /// </summary>
+    public enum MathStrategy
+    {
+        /// <summary>Use small loops. Slower, but doesn't cost any extra ROM.</summary>
+        Size,
+        /// <summary>Use lookup tables and unrolled loops. Much faster, but multiplication alone costs 512 bytes of ROM for tables.</summary>
+        Speed
+    }
 }
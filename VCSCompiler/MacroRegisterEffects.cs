@@ -0,0 +1,221 @@
+﻿#nullable enable
+using System;
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.IO;
+using System.Linq;
+using System.Text.RegularExpressions;
+using VCSFramework;
+
+namespace VCSCompiler
+{
+    [Flags]
+    internal enum IndexRegisters
+    {
+        None = 0,
+        X = 1,
+        Y = 2,
+        Both = X | Y
+    }
+
+    /// <summary>
+    /// Determines which index registers each VIL macro overwrites, by scanning the macro bodies in vil.h.
+    /// Used by the register allocator to find out if X or Y is free for the whole of a method.
+    /// </summary>
+    internal static class MacroRegisterEffects
+    {
+        private static readonly Regex MacroStartRegex = new(@"^(\w+)\s+\.macro\b");
+        private static readonly Regex DirectiveRegex = new(@"^\.(\w+)\b");
+        private static readonly Regex WritesXRegex = new(@"\b(LDX|TAX|TSX|INX|DEX)\b");
+        private static readonly Regex WritesYRegex = new(@"\b(LDY|TAY|INY|DEY)\b");
+        // Anything that leaves the macro may run code we can't see.
+        private static readonly Regex LeavesMacroRegex = new(@"\b(JSR|RTS|RTI|BRK)\b");
+        // Assembler directives that can appear in a macro body. Any other .name is an invocation of another macro.
+        private static readonly ImmutableHashSet<string> Directives = ImmutableHashSet.Create(StringComparer.OrdinalIgnoreCase,
+            "if", "elseif", "else", "endif", "for", "next", "let", "error", "errorif", "assert", "invoke", "return",
+            "block", "endblock", "function", "endfunction", "byte", "word", "align", "echo", "warn");
+
+        private static readonly Lazy<ImmutableDictionary<string, IndexRegisters>> Effects = new(() => Parse(ReadVilHeader()));
+
+        /// <summary>
+        /// Returns the index registers overwritten by <paramref name="entry"/>. Unknown macros and inline assembly
+        /// are assumed to overwrite both.
+        /// </summary>
+        public static IndexRegisters GetClobberedRegisters(IAssemblyEntry entry)
+        {
+            return entry switch
+            {
+                StackMutatingMacroCall sm => GetClobberedRegisters(sm.MacroCall),
+                // These only ever touch the register they were given.
+                PopToRegister m => RegisterOf(m.RegisterConstant),
+                AssignConstantToRegister m => RegisterOf(m.RegisterConstant),
+                IncrementRegister m => RegisterOf(m.RegisterConstant),
+                DecrementRegister m => RegisterOf(m.RegisterConstant),
+                PushRegister or BranchIfRegisterLessThanConstant or BranchIfRegisterLessThanGlobal or PushRomDataElementFromRegister => IndexRegisters.None,
+                IMacroCall macroCall => Effects.Value.TryGetValue(macroCall.Name, out var registers) ? registers : IndexRegisters.Both,
+                InlineAssembly => IndexRegisters.Both,
+                _ => IndexRegisters.None
+            };
+        }
+
+        /// <summary>Returns the register that holds an enregistered local, for the macros that read or write one.</summary>
+        public static IndexRegisters GetAllocatedRegister(IAssemblyEntry entry)
+        {
+            return entry switch
+            {
+                StackMutatingMacroCall sm => GetAllocatedRegister(sm.MacroCall),
+                PopToRegister m => RegisterOf(m.RegisterConstant),
+                PushRegister m => RegisterOf(m.RegisterConstant),
+                AssignConstantToRegister m => RegisterOf(m.RegisterConstant),
+                IncrementRegister m => RegisterOf(m.RegisterConstant),
+                DecrementRegister m => RegisterOf(m.RegisterConstant),
+                BranchIfRegisterLessThanConstant m => RegisterOf(m.RegisterConstant),
+                BranchIfRegisterLessThanGlobal m => RegisterOf(m.RegisterConstant),
+                PushRomDataElementFromRegister m => RegisterOf(m.RegisterConstant),
+                _ => IndexRegisters.None
+            };
+        }
+
+        public static void WarmUp() => _ = Effects.Value;
+
+        /// <summary>Converts a register index as used by popToRegister into an <see cref="IndexRegisters"/>.</summary>
+        public static IndexRegisters RegisterOf(Constant registerConstant) => registerConstant.Value switch
+        {
+            (byte)1 => IndexRegisters.X,
+            (byte)2 => IndexRegisters.Y,
+            _ => IndexRegisters.None
+        };
+
+        /// <summary>Converts an index register into the index popToRegister and friends expect.</summary>
+        public static Constant ConstantOf(IndexRegisters register) => register switch
+        {
+            IndexRegisters.X => new Constant((byte)1),
+            IndexRegisters.Y => new Constant((byte)2),
+            _ => throw new ArgumentException($"'{register}' is not a single index register.")
+        };
+
+        private static ImmutableArray<string> ReadVilHeader()
+        {
+            var path = Path.Combine(AppContext.BaseDirectory, "vil.h");
+            // Without the header every macro is treated as clobbering everything, which just disables allocation.
+            return File.Exists(path) ? File.ReadAllLines(path).ToImmutableArray() : ImmutableArray<string>.Empty;
+        }
+
+        private static ImmutableDictionary<string, IndexRegisters> Parse(ImmutableArray<string> lines)
+        {
+            var bodies = new Dictionary<string, ImmutableArray<string>.Builder>();
+            ImmutableArray<string>.Builder? currentBody = null;
+            foreach (var rawLine in lines)
+            {
+                var commentStart = rawLine.IndexOf("//", StringComparison.Ordinal);
+                var line = (commentStart >= 0 ? rawLine[..commentStart] : rawLine).Trim();
+
+                var macroStart = MacroStartRegex.Match(line);
+                if (macroStart.Success)
+                    bodies[macroStart.Groups[1].Value] = currentBody = ImmutableArray.CreateBuilder<string>();
+                else if (line.Equals(".endmacro", StringComparison.OrdinalIgnoreCase))
+                    currentBody = null;
+                else if (line.Length > 0)
+                    currentBody?.Add(line);
+            }
+
+            var effects = bodies.ToDictionary(pair => pair.Key, pair =>
+            {
+                var index = 0;
+                return ScanBlock(pair.Value.ToImmutable(), ref index);
+            });
+            var registers = effects.ToDictionary(pair => pair.Key, pair => pair.Value.Registers);
+
+            // Macros may invoke other macros, so propagate until nothing changes. Invoking something that isn't a macro
+            // in vil.h (or a directive) could do anything.
+            bool changed;
+            do
+            {
+                changed = false;
+                foreach (var (macro, effect) in effects)
+                {
+                    var combined = effect.Invocations.Aggregate(registers[macro], (r, name) => r | (registers.TryGetValue(name, out var invoked) ? invoked : IndexRegisters.Both));
+                    if (combined != registers[macro])
+                    {
+                        registers[macro] = combined;
+                        changed = true;
+                    }
+                }
+            } while (changed);
+
+            return registers.ToImmutableDictionary();
+        }
+
+        /// <summary>
+        /// Scans a macro body from <paramref name="index"/> up to the .elseif/.else/.endif that ends the current block.
+        /// Each branch of an .if is scanned on its own, and branches that always end in .error are left out since a
+        /// call that takes one never makes it into a ROM.
+        /// </summary>
+        private static BodyEffects ScanBlock(ImmutableArray<string> lines, ref int index)
+        {
+            var effects = new BodyEffects();
+            while (index < lines.Length)
+            {
+                var line = lines[index];
+                var directive = DirectiveRegex.Match(line);
+                var name = directive.Groups[1].Value.ToLowerInvariant();
+                if (directive.Success && name is "elseif" or "else" or "endif")
+                    break;
+                index++;
+
+                if (directive.Success && name == "if")
+                {
+                    var hasElse = false;
+                    var everyBranchFails = true;
+                    while (true)
+                    {
+                        var branch = ScanBlock(lines, ref index);
+                        if (!branch.AlwaysFails)
+                        {
+                            effects.Add(branch);
+                            everyBranchFails = false;
+                        }
+                        if (index == lines.Length)
+                            break;
+                        var end = DirectiveRegex.Match(lines[index++]).Groups[1].Value.ToLowerInvariant();
+                        if (end == "endif")
+                            break;
+                        hasElse |= end == "else";
+                    }
+                    // Without an .else, skipping every branch is a path too.
+                    effects.AlwaysFails |= hasElse && everyBranchFails;
+                }
+                else if (directive.Success)
+                {
+                    if (name == "error")
+                        effects.AlwaysFails = true;
+                    else if (!Directives.Contains(name))
+                        effects.Invocations.Add(directive.Groups[1].Value);
+                }
+                else
+                {
+                    if (WritesXRegex.IsMatch(line))
+                        effects.Registers |= IndexRegisters.X;
+                    if (WritesYRegex.IsMatch(line))
+                        effects.Registers |= IndexRegisters.Y;
+                    if (LeavesMacroRegex.IsMatch(line))
+                        effects.Registers = IndexRegisters.Both;
+                }
+            }
+            return effects;
+        }
+
+        private sealed class BodyEffects
+        {
+            public IndexRegisters Registers { get; set; }
+            public HashSet<string> Invocations { get; } = new();
+            public bool AlwaysFails { get; set; }
+
+            public void Add(BodyEffects other)
+            {
+                Registers |= other.Registers;
+                Invocations.UnionWith(other.Invocations);
+            }
+        }
+    }
+}
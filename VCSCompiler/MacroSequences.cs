@@ -0,0 +1,112 @@
+#nullable enable
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.Linq;
+using VCSFramework;
+
+namespace VCSCompiler
+{
+    /// <summary>
+    /// Describes runs of adjacent macro calls by their shape, so common sequences can be found and fused into composite macros.
+    /// </summary>
+    /// <remarks>
+    /// A shape looks like "pushGlobal(g0,t,1) + pushConstant(c0,t,1) + addFromStack(s,s,s,s) + popToGlobal(g0,t,1,s,s)".
+    /// Each parameter is written as one of:
+    /// g{n}: a RAM global, numbered by first appearance so repeated uses of the same global share a number.
+    /// io: a predefined global (e.g. a TIA register). r: a reserved global. c{n}: a constant, each numbered separately.
+    /// t: a type. 1: a size of exactly 1 byte. n: any other size. s: a stack type/size, resolved during assembly.
+    /// b: a branch target. x: anything else.
+    /// </remarks>
+    internal static class MacroSequences
+    {
+        public const int MinLength = 2;
+        public const int MaxLength = 4;
+
+        /// <summary>Counts every shape of length <see cref="MinLength"/> to <see cref="MaxLength"/> in the given functions.</summary>
+        public static ImmutableDictionary<string, int> Count(IEnumerable<Function> functions)
+        {
+            var counts = new Dictionary<string, int>();
+            foreach (var run in functions.SelectMany(f => AdjacentRuns(f.Body)))
+            {
+                for (var start = 0; start < run.Count; start++)
+                {
+                    for (var length = MinLength; length <= MaxLength && start + length <= run.Count; length++)
+                    {
+                        var shape = Describe(run.Skip(start).Take(length));
+                        counts[shape] = counts.TryGetValue(shape, out var count) ? count + 1 : 1;
+                    }
+                }
+            }
+            return counts.ToImmutableDictionary();
+        }
+
+        public static string Describe(IEnumerable<IMacroCall> macroCalls)
+        {
+            var globals = new List<IGlobalLabel>();
+            var constantCount = 0;
+            return string.Join(" + ", macroCalls.Select(m => $"{m.Name}({string.Join(",", m.Parameters.Select(DescribeParameter))})"));
+
+            string DescribeParameter(IExpression parameter)
+            {
+                switch (parameter)
+                {
+                    case PredefinedGlobalLabel:
+                        return "io";
+                    case ReservedGlobalLabel:
+                        return "r";
+                    // RomData lives in ROM at an absolute address, it's not something a composite can read like RAM.
+                    case RomDataGlobalLabel:
+                        return "x";
+                    case IGlobalLabel global:
+                        var index = globals.FindIndex(g => g.Equals(global));
+                        if (index < 0)
+                        {
+                            index = globals.Count;
+                            globals.Add(global);
+                        }
+                        return $"g{index}";
+                    case Constant:
+                        return $"c{constantCount++}";
+                    case ITypeLabel:
+                        return "t";
+                    case TypeSizeLabel size:
+                        return IsByteSized(size) ? "1" : "n";
+                    case ISizeLabel:
+                        return "n";
+                    case StackSizeArrayAccess:
+                    case StackTypeArrayAccess:
+                        return "s";
+                    case IBranchTargetLabel:
+                        return "b";
+                    default:
+                        return "x";
+                }
+            }
+        }
+
+        public static bool IsByteSized(ISizeLabel size)
+            => size is TypeSizeLabel { Type: var type }
+            && (type.Type.FullName == BuiltInDefinitions.Byte.FullName || type.Type.FullName == BuiltInDefinitions.Bool.FullName);
+
+        /// <summary>Splits a body into runs of macro calls that are executed back to back. Labels and anything else break a run.</summary>
+        private static IEnumerable<List<IMacroCall>> AdjacentRuns(ImmutableArray<IAssemblyEntry> body)
+        {
+            var run = new List<IMacroCall>();
+            foreach (var entry in body)
+            {
+                if (entry is IMacroCall macroCall)
+                {
+                    run.Add(macroCall is StackMutatingMacroCall stackMutating ? stackMutating.MacroCall : macroCall);
+                }
+                else if (entry is not Comment)
+                {
+                    if (run.Count >= MinLength)
+                        yield return run;
+                    run = new();
+                }
+            }
+            if (run.Count >= MinLength)
+                yield return run;
+        }
+    }
+}
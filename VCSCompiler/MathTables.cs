@@ -0,0 +1,37 @@
+﻿#nullable enable
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.Linq;
+using VCSFramework;
+
+namespace VCSCompiler
+{
+    /// <summary>
+    /// Lookup tables needed by math macros when compiling with <see cref="MathStrategy.Speed"/>.
+    /// Tables are only emitted if a macro that uses them made it through optimization.
+    /// </summary>
+    internal static class MathTables
+    {
+        // Names must match the labels referenced in vil.h. Each table is emitted page-aligned.
+        private static readonly BranchTargetLabel QuarterSquaresLowLabel = new("MATH_QUARTER_SQUARES_0");
+        private static readonly BranchTargetLabel QuarterSquaresHighLabel = new("MATH_QUARTER_SQUARES_1");
+
+        public static ImmutableArray<(ILabel Label, ImmutableArray<byte> Data)> GetRequiredTables(IEnumerable<IMacroCall> macroCalls)
+        {
+            var usesQuarterSquares = macroCalls
+                .Select(m => m is StackMutatingMacroCall sm ? sm.MacroCall : m)
+                .OfType<MultiplyFromStack>()
+                .Any(m => m.UseTableConstant.Value is byte b && b != 0);
+
+            if (!usesQuarterSquares)
+                return ImmutableArray<(ILabel, ImmutableArray<byte>)>.Empty;
+
+            // a*b = floor((a+b)^2/4) - floor((a-b)^2/4). Only the low byte of the product is needed, so only the low
+            // byte of each square is stored. a+b can be up to 510, so it's split across two 256-byte tables.
+            var quarterSquares = Enumerable.Range(0, 512).Select(n => (byte)(n * n / 4)).ToImmutableArray();
+            return ImmutableArray.Create<(ILabel, ImmutableArray<byte>)>(
+                (QuarterSquaresLowLabel, quarterSquares.Take(256).ToImmutableArray()),
+                (QuarterSquaresHighLabel, quarterSquares.Skip(256).ToImmutableArray()));
+        }
+    }
+}
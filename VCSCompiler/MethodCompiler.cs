@@ -60,6 +60,8 @@ namespace VCSCompiler
                 body = body.Prepend(new EntryPoint()).ToImmutableArray();
             }
             body = Optimize(body);
+            if (!Compiler.Options.DisableOptimizations)
+                body = AllocateRegisters(body);
             var inlineString = Inline ? " inline call of " : " ";
             if (!Inline)
             {
@@ -86,7 +88,9 @@ namespace VCSCompiler
                 preOptimize = postOptimize;
                 if (!Compiler.Options.DisableOptimizations)
                 {
-                    postOptimize = OptionalOptimizations.Aggregate(preOptimize, (entries, optimizer) => Optimize(entries, UserPair, optimizer));
+                    // Superoptimized rules go last so the hand-written ones keep priority over sequences they already cover.
+                    var optimizers = Compiler.Options.DisableSuperoptimizations ? OptionalOptimizations : OptionalOptimizations.AddRange(SuperoptimizedOptimizations);
+                    postOptimize = optimizers.Aggregate(preOptimize, (entries, optimizer) => Optimize(entries, UserPair, optimizer));
                 }
                 postOptimize = MandatoryOptimizations.Aggregate(postOptimize, (entries, optimizer) => Optimize(entries, UserPair, optimizer));
             } while (!preOptimize.SequenceEqual(postOptimize));
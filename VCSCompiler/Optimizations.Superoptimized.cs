@@ -0,0 +1,76 @@
+// <auto-generated>
+// Generated by VILSuperoptimizer from the macro sequences most common in Samples. Do not edit by hand, rerun the tool instead.
+// Each rule fuses a sequence into the matching composite macro in the superoptimized section of vil.h.
+// </auto-generated>
+#nullable enable
+using System.Collections.Immutable;
+using System.Linq;
+using VCSFramework;
+
+namespace VCSCompiler
+{
+    internal partial class MethodCompiler
+    {
+        private static readonly ImmutableArray<Optimizer> SuperoptimizedOptimizations = new Optimizer[]
+        {
+            // pushGlobal(g0,t,1) + pushConstant(c0,t,1) + subFromStack(s,s,s,s) + popToGlobal(g0,t,1,s,s)
+            (_, next) => next switch
+            {
+                (PushGlobal(var inst0, var global0, _, var size0),
+                (PushConstant(var inst1, var constant0, _, var size1),
+                (SubFromStack(var inst2, _, _, _, _),
+                (PopToGlobal(var inst3, var alias0, _, var size2, _, _), var trueNext))))
+                    when IsSuperoptimizableGlobal(global0) && MacroSequences.IsByteSized(size0) && MacroSequences.IsByteSized(size1) && alias0.Equals(global0) && MacroSequences.IsByteSized(size2)
+                    => new(new FusedPushGlobalPushConstantSubFromStackPopToGlobalG0C0G0(inst0.Concat(inst1).Concat(inst2).Concat(inst3), global0, constant0), trueNext),
+                _ => next
+            },
+
+            // pushGlobal(g0,t,1) + pushConstant(c0,t,1) + subFromStack(s,s,s,s)
+            (_, next) => next switch
+            {
+                (PushGlobal(var inst0, var global0, _, var size0),
+                (PushConstant(var inst1, var constant0, _, var size1),
+                (SubFromStack(var inst2, _, _, _, _), var trueNext)))
+                    when IsSuperoptimizableGlobal(global0) && MacroSequences.IsByteSized(size0) && MacroSequences.IsByteSized(size1)
+                    => new(new FusedPushGlobalPushConstantSubFromStackG0C0(inst0.Concat(inst1).Concat(inst2), global0, constant0), trueNext),
+                _ => next
+            },
+
+            // pushGlobal(g0,t,1) + pushConstant(c0,t,1) + andFromStack(s,s,s,s)
+            (_, next) => next switch
+            {
+                (PushGlobal(var inst0, var global0, _, var size0),
+                (PushConstant(var inst1, var constant0, _, var size1),
+                (AndFromStack(var inst2, _, _, _, _), var trueNext)))
+                    when IsSuperoptimizableGlobal(global0) && MacroSequences.IsByteSized(size0) && MacroSequences.IsByteSized(size1)
+                    => new(new FusedPushGlobalPushConstantAndFromStackG0C0(inst0.Concat(inst1).Concat(inst2), global0, constant0), trueNext),
+                _ => next
+            },
+
+            // pushGlobal(g0,t,1) + branchTrueFromStack(b)
+            (_, next) => next switch
+            {
+                (PushGlobal(var inst0, var global0, _, var size0),
+                (BranchTrueFromStack(var inst1, var branchTarget), var trueNext))
+                    when IsSuperoptimizableGlobal(global0) && MacroSequences.IsByteSized(size0)
+                    => new(new FusedPushGlobalBranchTrueFromStackG0(inst0.Concat(inst1), global0, branchTarget), trueNext),
+                _ => next
+            },
+
+            // pushGlobal(g0,t,1) + branchFalseFromStack(b)
+            (_, next) => next switch
+            {
+                (PushGlobal(var inst0, var global0, _, var size0),
+                (BranchFalseFromStack(var inst1, var branchTarget), var trueNext))
+                    when IsSuperoptimizableGlobal(global0) && MacroSequences.IsByteSized(size0)
+                    => new(new FusedPushGlobalBranchFalseFromStackG0(inst0.Concat(inst1), global0, branchTarget), trueNext),
+                _ => next
+            },
+
+        }.ToImmutableArray();
+
+        /// <summary>Superoptimized macros were only verified against distinct, plain RAM globals.</summary>
+        private static bool IsSuperoptimizableGlobal(IGlobalLabel global)
+            => global is not (PredefinedGlobalLabel or ReservedGlobalLabel or RomDataGlobalLabel);
+    }
+}
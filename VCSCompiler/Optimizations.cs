@@ -47,7 +47,7 @@ namespace VCSCompiler
                 (PushAddressOfGlobal(_, GlobalFieldLabel global, _ ,_),
                 (RomDataLengthCall(var romDataInstruction), var trueNext)) =>
                     new(new PushConstant(romDataInstruction, 
-                        new Constant(LengthOf(userPair.Assembly, (FieldDefinition)global.Field)), new TypeLabel(BuiltInDefinitions.Byte), new TypeSizeLabel(BuiltInDefinitions.Byte)), trueNext),
+                        new Constant(LengthOf(userPair, (FieldDefinition)global.Field)), new TypeLabel(BuiltInDefinitions.Byte), new TypeSizeLabel(BuiltInDefinitions.Byte)), trueNext),
                 _ => next
             },
             (userPair, next) => next switch
@@ -64,7 +64,7 @@ namespace VCSCompiler
                 (RomDataGetPointerCall(var romDataInst), var trueNext)) =>
                     new(new PushAddressOfRomDataElementFromConstant(
                         ArrayOf(pushInst, romDataInst),
-                        new RomDataGlobalLabel(GetGeneratorMethod((FieldDefinition)global.Field)),
+                        LabelOf((FieldDefinition)global.Field),
                         GetRomDataArgType(global.Field),
                         GetRomDataArgSize(global.Field),
                         new Constant(0)), trueNext),
@@ -88,7 +88,7 @@ namespace VCSCompiler
                 (RomDataGetterCall(var getInst), var trueNext))) => 
                     new(new PushAddressOfRomDataElementFromConstant(
                         ArrayOf(pushGlobalInst, pushConstantInst, getInst), 
-                        new RomDataGlobalLabel(GetGeneratorMethod((FieldDefinition)global.Field)), 
+                        LabelOf((FieldDefinition)global.Field), 
                         GetRomDataArgType(global.Field), 
                         GetRomDataArgSize(global.Field), 
                         constant), trueNext),
@@ -102,7 +102,17 @@ namespace VCSCompiler
                     new(pushGlobal,
                         new(new PushAddressOfRomDataElementFromStack(
                         ArrayOf(pushGlobalInst, getInst),
-                        new RomDataGlobalLabel(GetGeneratorMethod((FieldDefinition)global.Field)),
+                        LabelOf((FieldDefinition)global.Field),
+                        GetRomDataArgType(global.Field),
+                        GetRomDataArgSize(global.Field)), trueNext)),
+                // Indexing by a local (e.g. a loop counter) instead of a field.
+                (PushAddressOfGlobal(var pushGlobalInst, GlobalFieldLabel global, _ ,_),
+                (PushLocal pushLocal,
+                (RomDataGetterCall(var getInst), var trueNext))) =>
+                    new(pushLocal,
+                        new(new PushAddressOfRomDataElementFromStack(
+                        ArrayOf(pushGlobalInst, getInst),
+                        LabelOf((FieldDefinition)global.Field),
                         GetRomDataArgType(global.Field),
                         GetRomDataArgSize(global.Field)), trueNext)),
                 _ => next
@@ -125,9 +135,19 @@ namespace VCSCompiler
             (_, next) => next switch
             {
                 // Pushing an integer and popping to a boolean is valid CIL, so requiring identical types would be incorrect.
-                (PushConstant(var instA, var constant, _, var size),
-                (PopToGlobal(var instB, var global, _, _, _, _), var trueNext))
-                    => new(new AssignConstantToGlobal(instA.Concat(instB), constant, global, size), trueNext),
+                // The global's size is what gets written, e.g. a byte constant assigned to a ushort is zero-extended.
+                (PushConstant(var instA, var constant, _, _),
+                (PopToGlobal(var instB, var global, _, var globalSize, _, _), var trueNext))
+                    => new(new AssignConstantToGlobal(instA.Concat(instB), constant, global, globalSize), trueNext),
+                _ => next
+            },
+
+            // Converting a constant byte to a Fixed8_8 can be done at compile time.
+            (_, next) => next switch
+            {
+                (PushConstant(var instA, var constant, _, _),
+                (ConvertByteToFixedPointFromStack, var trueNext)) when constant.Value is byte b
+                    => new(new PushConstant(instA, new Constant((ushort)(b << 8)), new TypeLabel(BuiltInDefinitions.Fixed8_8), new TypeSizeLabel(BuiltInDefinitions.Fixed8_8)), trueNext),
                 _ => next
             },
 
@@ -140,6 +160,24 @@ namespace VCSCompiler
                 _ => next
             },
 
+            // Reading through a pointer that's already in a global can use it in place, instead of popping it into INTERNAL_RESERVED_0/1.
+            (_, next) => next switch
+            {
+                (PushGlobal(var instA, var global, var globalType, var globalSize),
+                (PushFieldFromStack(var instB, var offset, var fieldType, var fieldSize, _, _), var trueNext))
+                    => new(new PushFieldFromPointerGlobal(instA.Concat(instB), offset, fieldType, fieldSize, global, globalType, globalSize), trueNext),
+                (PushLocal(var instA, var local, var localType, var localSize),
+                (PushFieldFromStack(var instB, var offset, var fieldType, var fieldSize, _, _), var trueNext))
+                    => new(new PushFieldFromPointerGlobal(instA.Concat(instB), offset, fieldType, fieldSize, local, localType, localSize), trueNext),
+                (PushLocal(var instA, var local, _, var localSize),
+                (PushDereferenceFromStack(var instB, _, var type, var size), var trueNext))
+                    => new(new PushDereferenceFromPointerGlobal(instA.Concat(instB), local, localSize, type, size), trueNext),
+                (PushGlobal(var instA, var global, _, var globalSize),
+                (PushDereferenceFromStack(var instB, _, var type, var size), var trueNext))
+                    => new(new PushDereferenceFromPointerGlobal(instA.Concat(instB), global, globalSize, type, size), trueNext),
+                _ => next
+            },
+
             // Adding a global and constant via the stack can be done in one macro, avoiding putting the constant on the stack.
             (_, next) => next switch
             {
@@ -170,6 +208,95 @@ namespace VCSCompiler
                 (AddFromGlobalAndConstantToGlobal(var inst, var sourceGlobal, var globalType, var globalSize, var constant, _, _, var targetGlobal, _, _), var trueNext)
                     when sourceGlobal == targetGlobal && constant.Value is byte b && b == 1
                     => new(new IncrementGlobal(inst, targetGlobal, globalType, globalSize), trueNext),
+                (SubFromGlobalAndConstantToGlobal(var inst, var sourceGlobal, var globalType, var globalSize, var constant, _, _, var targetGlobal, _, _), var trueNext)
+                    when sourceGlobal == targetGlobal && constant.Value is byte b && b == 1
+                    => new(new DecrementGlobal(inst, targetGlobal, globalType, globalSize), trueNext),
+                _ => next
+            },
+
+            // 16-bit math between globals and constants can be done directly in zero-page, instead of moving 4 bytes through the stack.
+            // Byte-sized math is left alone, so those locals can still be enregistered and the superoptimized rules still apply.
+            (_, next) => next switch
+            {
+                (PushGlobal(var instA, var global, var globalType, var globalSize),
+                (PushConstant(var instB, var constant, var constantType, var constantSize),
+                (SubFromStack(var instC, _, _, _, _),
+                (PopToGlobal(var instD, var targetGlobal, var targetType, var targetSize, _, _), var trueNext))))
+                    when !MacroSequences.IsByteSized(globalSize) || !MacroSequences.IsByteSized(targetSize)
+                    => new(new SubFromGlobalAndConstantToGlobal(instA.Concat(instB.Concat(instC.Concat(instD))), global, globalType, globalSize, constant, constantType, constantSize, targetGlobal, targetType, targetSize), trueNext),
+                (PushGlobal(var instA, var firstGlobal, _, var firstSize),
+                (PushGlobal(var instB, var secondGlobal, _, var secondSize),
+                (AddFromStack(var instC, _, _, _, _),
+                (PopToGlobal(var instD, var targetGlobal, _, var targetSize, _, _), var trueNext))))
+                    when !MacroSequences.IsByteSized(firstSize) || !MacroSequences.IsByteSized(secondSize) || !MacroSequences.IsByteSized(targetSize)
+                    => new(new AddFromGlobalAndGlobalToGlobal(instA.Concat(instB.Concat(instC.Concat(instD))), firstGlobal, firstSize, secondGlobal, secondSize, targetGlobal, targetSize), trueNext),
+                (PushGlobal(var instA, var firstGlobal, _, var firstSize),
+                (PushGlobal(var instB, var secondGlobal, _, var secondSize),
+                (SubFromStack(var instC, _, _, _, _),
+                (PopToGlobal(var instD, var targetGlobal, _, var targetSize, _, _), var trueNext))))
+                    when !MacroSequences.IsByteSized(firstSize) || !MacroSequences.IsByteSized(secondSize) || !MacroSequences.IsByteSized(targetSize)
+                    => new(new SubFromGlobalAndGlobalToGlobal(instA.Concat(instB.Concat(instC.Concat(instD))), firstGlobal, firstSize, secondGlobal, secondSize, targetGlobal, targetSize), trueNext),
+                (PushGlobal(var instA, var global, var globalType, var globalSize),
+                (PushConstant(var instB, var constant, var constantType, var constantSize),
+                (BranchIfLessThanFromStack(var instC, _, _, _, _, var target), var trueNext)))
+                    when !MacroSequences.IsByteSized(globalSize)
+                    => new(new BranchIfGlobalLessThanConstant(instA.Concat(instB.Concat(instC)), global, globalType, globalSize, constant, constantType, constantSize, target), trueNext),
+                _ => next
+            },
+
+            // Math with a constant operand can be strength-reduced to shifts/adds/masks instead of going through the generic routines.
+            (_, next) => next switch
+            {
+                (PushConstant(var instA, var constant, _, _),
+                (MultiplyFromStack(var instB, _, _, _, _, _), var trueNext))
+                    => new(new MultiplyFromStackByConstant(instA.Concat(instB), constant, new(0), new(0)), trueNext),
+                (PushConstant(var instA, var constant, _, _),
+                (DivideFromStack(var instB, _, _, _, _, var unroll), var trueNext))
+                    => new(new DivideFromStackByConstant(instA.Concat(instB), constant, new(0), new(0), unroll), trueNext),
+                (PushConstant(var instA, var constant, _, _),
+                (RemainderFromStack(var instB, _, _, _, _, var unroll), var trueNext))
+                    => new(new RemainderFromStackByConstant(instA.Concat(instB), constant, new(0), new(0), unroll), trueNext),
+                (PushConstant(var instA, var constant, _, _),
+                (ShiftLeftFromStack(var instB, _, _, _, _), var trueNext))
+                    => new(new ShiftLeftFromStackByConstant(instA.Concat(instB), constant, new(0), new(0)), trueNext),
+                (PushConstant(var instA, var constant, _, _),
+                (ShiftRightFromStack(var instB, _, _, _, _), var trueNext))
+                    => new(new ShiftRightFromStackByConstant(instA.Concat(instB), constant, new(0), new(0)), trueNext),
+                _ => next
+            },
+
+            // Once a local has been enregistered its push/pop traffic can use the register directly.
+            (_, next) => next switch
+            {
+                (PushConstant(var instA, var constant, _, _),
+                (PopToRegister(var instB, var register, _, _), var trueNext)) when MacroRegisterEffects.RegisterOf(register) != IndexRegisters.None
+                    => new(new AssignConstantToRegister(instA.Concat(instB), constant, register), trueNext),
+                (PushRegister(var instA, var register, _, _),
+                (PushConstant(var instB, var constant, _, _),
+                (AddFromStack(var instC, _, _, _, _),
+                (PopToRegister(var instD, var targetRegister, _, _), var trueNext)))) when register == targetRegister && constant.Value is byte b && b == 1
+                    => new(new IncrementRegister(instA.Concat(instB.Concat(instC.Concat(instD))), register), trueNext),
+                (PushRegister(var instA, var register, _, _),
+                (PushConstant(var instB, var constant, _, _),
+                (SubFromStack(var instC, _, _, _, _),
+                (PopToRegister(var instD, var targetRegister, _, _), var trueNext)))) when register == targetRegister && constant.Value is byte b && b == 1
+                    => new(new DecrementRegister(instA.Concat(instB.Concat(instC.Concat(instD))), register), trueNext),
+                (PushRegister(var instA, var register, _, _),
+                (PushConstant(var instB, var constant, _, var constantSize),
+                (BranchIfLessThanFromStack(var instC, _, _, _, _, var target), var trueNext))) when MacroSequences.IsByteSized(constantSize)
+                    => new(new BranchIfRegisterLessThanConstant(instA.Concat(instB.Concat(instC)), register, constant, target), trueNext),
+                (PushRegister(var instA, var register, _, _),
+                (PushGlobal(var instB, var global, _, var globalSize),
+                (BranchIfLessThanFromStack(var instC, _, _, _, _, var target), var trueNext)))
+                    => new(new BranchIfRegisterLessThanGlobal(instA.Concat(instB.Concat(instC)), register, global, globalSize, target), trueNext),
+                (PushRegister(var instA, var register, _, _),
+                (PushLocal(var instB, var local, _, var localSize),
+                (BranchIfLessThanFromStack(var instC, _, _, _, _, var target), var trueNext)))
+                    => new(new BranchIfRegisterLessThanGlobal(instA.Concat(instB.Concat(instC)), register, local, localSize, target), trueNext),
+                (PushRegister(var instA, var register, _, _),
+                (PushAddressOfRomDataElementFromStack(var instB, var romDataGlobal, _, var referentTypeSize),
+                (PushDereferenceFromStack(var instC, _, var type, var size), var trueNext)))
+                    => new(new PushRomDataElementFromRegister(instA.Concat(instB.Concat(instC)), romDataGlobal, referentTypeSize, register, type, size), trueNext),
                 _ => next
             },
 
@@ -186,37 +313,6 @@ namespace VCSCompiler
             },
         }.ToImmutableArray();
 
-        private static MethodDef GetGeneratorMethod(FieldDefinition field)
-        {
-            // @TODO - Add check that RomData<> type arg is public, or else `dynamic` will fail.
-            if (field.TryGetFrameworkAttribute<RomDataGeneratorAttribute>(out var attribute))
-            {
-                var methodName = attribute.MethodName;
-                var expectedArg = ((GenericInstanceType)field.FieldType).GenericArguments.Single();
-                var matchingMethods = field.DeclaringType.Methods.Concat(field.DeclaringType.DeclaringType?.Methods ?? Enumerable.Empty<MethodDefinition>())
-                    .Where(m => m.IsStatic)
-                    .Where(m => m.Name == methodName)
-                    .Where(m => !m.Parameters.Any())
-                    .Where(m => m.ReturnType is GenericInstanceType)
-                    .Where(m => ((GenericInstanceType)m.ReturnType).GenericArguments.SingleOrDefault()?.FullName == expectedArg.FullName)
-                    .Where(m => ((GenericInstanceType)m.ReturnType).ElementType.FullName == BuiltInDefinitions.IEnumerable.FullName)
-                    .ToImmutableArray();
-                var expectedMethod = $"static IEnumerable<{expectedArg.Name}> {methodName}() {{ /** ... */ }}";
-                // ReturnType.GenericArguments should equal field's argument
-                // ReturnType.ElementType == IEnumerable`1
-                return matchingMethods.Length switch
-                {
-                    0 => throw new InvalidOperationException($"No matching RomData generator method found for field '{field.FullName}'. Expected a method on type '{field.DeclaringType.FullName}' that matches: '{expectedMethod}'"),
-                    1 => matchingMethods.Single(),
-                    _ => throw new InvalidOperationException($"Multiple RomData generators found for field '{field.FullName}'. There should only be 1 match. Matches:{Environment.NewLine}{string.Join(Environment.NewLine, matchingMethods.Select(m => m.FullName))}")
-                };
-            }
-            else
-            {
-                throw new InvalidOperationException($"Field '{field.FullName}' must be tagged with a {nameof(RomDataGeneratorAttribute)} in order to be used as a RomData.");
-            }
-        }
-
         private static ImmutableArray<T> ArrayOf<T>(params T[] values) => values.ToImmutableArray();
 
         private static ITypeLabel GetRomDataArgType(FieldReference field)
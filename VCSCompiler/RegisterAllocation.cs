@@ -0,0 +1,149 @@
+﻿#nullable enable
+using System;
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.Linq;
+using VCSFramework;
+
+namespace VCSCompiler
+{
+    internal partial class MethodCompiler
+    {
+        /// <summary>
+        /// Moves 1-byte locals used inside loops (induction variables, indices) out of zero-page and into X or Y.
+        /// A local is only enregistered if every use of it can be rewritten into a register macro, and a register is
+        /// only handed out if nothing overwrites it while the local is live (including inlined code and anything
+        /// reached through a JSR). Innermost loops get first pick since that's where the saved cycles add up.
+        /// Runs after optimizations so it sees every macro that will be emitted. Each register is tried by rewriting
+        /// the local's push/pop macros and re-running the optimizer, which fuses them into register macros (INX, CPX,
+        /// etc.), so macros the fusions absorb aren't held against the register.
+        /// </summary>
+        private ImmutableArray<IAssemblyEntry> AllocateRegisters(ImmutableArray<IAssemblyEntry> entries)
+        {
+            var loops = FindLoops(entries);
+            if (!loops.Any())
+                return entries;
+            var innermostLoops = loops
+                .Where(loop => !loops.Any(other => other != loop && other.Start >= loop.Start && other.End <= loop.End))
+                .ToImmutableArray();
+
+            var candidates = entries
+                .SelectMany((entry, index) => ReferencedLocals(entry).Select(local => (Local: local, Index: index)))
+                .Where(use => loops.Any(loop => loop.Start <= use.Index && use.Index <= loop.End))
+                .GroupBy(use => use.Local)
+                .Where(group => IsEnregisterable(entries, group.Key))
+                .OrderByDescending(group => group.Any(use => innermostLoops.Any(loop => loop.Start <= use.Index && use.Index <= loop.End)))
+                .ThenByDescending(group => group.Count())
+                .Select(group => group.Key)
+                .ToImmutableArray();
+
+            // Registers already holding a local (this method's, or one inlined into it) aren't shared.
+            var allocated = entries.Aggregate(IndexRegisters.None, (registers, entry) => registers | MacroRegisterEffects.GetAllocatedRegister(entry));
+            foreach (var local in candidates)
+            {
+                foreach (var register in new[] { IndexRegisters.X, IndexRegisters.Y }.Where(r => (allocated & r) == 0))
+                {
+                    var registerConstant = MacroRegisterEffects.ConstantOf(register);
+                    var enregistered = Optimize(entries.Select(entry => Enregister(entry, local, registerConstant)).ToImmutableArray());
+                    if (!IsFreeWhileLive(enregistered, register))
+                        continue;
+                    entries = enregistered;
+                    allocated |= register;
+                    break;
+                }
+            }
+            return entries;
+
+            static bool IsFreeWhileLive(ImmutableArray<IAssemblyEntry> entries, IndexRegisters register)
+            {
+                var uses = entries
+                    .Select((entry, index) => (entry, index))
+                    .Where(pair => MacroRegisterEffects.GetAllocatedRegister(pair.entry) == register)
+                    .Select(pair => pair.index)
+                    .ToImmutableArray();
+                if (!uses.Any())
+                    return true;
+
+                // The local is live somewhere between its first and last use, and throughout any loop that overlaps
+                // them, since the loop can carry its value around. Code outside of that (e.g. entryPoint's clearing
+                // loop, or the final RTS) can do what it likes with the register.
+                var (start, end) = (uses.Min(), uses.Max());
+                var loops = FindLoops(entries);
+                bool grew;
+                do
+                {
+                    grew = false;
+                    foreach (var loop in loops.Where(loop => loop.Start <= end && loop.End >= start && (loop.Start < start || loop.End > end)))
+                    {
+                        (start, end) = (Math.Min(start, loop.Start), Math.Max(end, loop.End));
+                        grew = true;
+                    }
+                } while (grew);
+
+                var clobbered = entries
+                    .Skip(start)
+                    .Take(end - start + 1)
+                    .Where(entry => MacroRegisterEffects.GetAllocatedRegister(entry) != register)
+                    .Aggregate(IndexRegisters.None, (registers, entry) => registers | MacroRegisterEffects.GetClobberedRegisters(entry));
+                return (clobbered & register) == 0;
+            }
+
+            static ImmutableArray<(int Start, int End)> FindLoops(ImmutableArray<IAssemblyEntry> entries)
+            {
+                // A loop is any branch back to a label that came before it.
+                var labelIndices = entries
+                    .Select((entry, index) => (entry, index))
+                    .Where(pair => pair.entry is IBranchTargetLabel)
+                    // Inlining the same method twice duplicates its labels (they're scoped by blocks), the first is good enough here.
+                    .GroupBy(pair => (IBranchTargetLabel)pair.entry)
+                    .ToImmutableDictionary(group => group.Key, group => group.First().index);
+                return entries
+                    .Select((entry, index) => (entry, index))
+                    .SelectMany(pair => pair.entry is IMacroCall macroCall
+                        ? macroCall.Parameters.OfType<IBranchTargetLabel>().Select(target => (Target: target, BranchIndex: pair.index))
+                        : Enumerable.Empty<(IBranchTargetLabel Target, int BranchIndex)>())
+                    .Where(branch => labelIndices.TryGetValue(branch.Target, out var labelIndex) && labelIndex < branch.BranchIndex)
+                    .Select(branch => (labelIndices[branch.Target], branch.BranchIndex))
+                    .Distinct()
+                    .ToImmutableArray();
+            }
+
+            bool IsEnregisterable(ImmutableArray<IAssemblyEntry> entries, LocalGlobalLabel local)
+            {
+                if (local.Method != new MethodDef(Method))
+                    return false;
+                var variableType = local.Method.Body.Variables[local.Index].VariableType;
+                if (variableType.FullName != BuiltInDefinitions.Byte.FullName && variableType.FullName != BuiltInDefinitions.Bool.FullName)
+                    return false;
+                return entries
+                    .Where(entry => ReferencedLocals(entry).Contains(local))
+                    .All(entry => entry is PushLocal or PushGlobal or PopToLocal or PopToGlobal or AssignConstantToGlobal or IncrementGlobal);
+            }
+
+            static IAssemblyEntry Enregister(IAssemblyEntry entry, LocalGlobalLabel local, Constant register) => entry switch
+            {
+                PushLocal(var inst, var l, var type, var size) when local.Equals(l) => new PushRegister(inst, register, type, size),
+                PushGlobal(var inst, var g, var type, var size) when local.Equals(g) => new PushRegister(inst, register, type, size),
+                PopToLocal(var inst, var l, _, _, var stackType, var stackSize) when local.Equals(l) => new PopToRegister(inst, register, stackType, stackSize),
+                PopToGlobal(var inst, var g, _, _, var stackType, var stackSize) when local.Equals(g) => new PopToRegister(inst, register, stackType, stackSize),
+                AssignConstantToGlobal(var inst, var constant, var g, _) when local.Equals(g) => new AssignConstantToRegister(inst, constant, register),
+                IncrementGlobal(var inst, var g, _, _) when local.Equals(g) => new IncrementRegister(inst, register),
+                _ => entry
+            };
+        }
+
+        private static IEnumerable<LocalGlobalLabel> ReferencedLocals(IAssemblyEntry entry)
+        {
+            return entry is IMacroCall macroCall
+                ? macroCall.Parameters.SelectMany(Flatten).OfType<LocalGlobalLabel>().Distinct()
+                : Enumerable.Empty<LocalGlobalLabel>();
+
+            static IEnumerable<IExpression> Flatten(IExpression expression) => expression switch
+            {
+                IFunctionCall functionCall => functionCall.Parameters.SelectMany(Flatten).Prepend(functionCall),
+                PointerGlobalSizeLabel pointerSize => new IExpression[] { pointerSize, pointerSize.Global },
+                _ => new[] { expression }
+            };
+        }
+    }
+}
@@ -0,0 +1,297 @@
+﻿#nullable enable
+using Mono.Cecil;
+using Mono.Cecil.Cil;
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.IO;
+using System.IO.MemoryMappedFiles;
+using System.Linq;
+using System.Reflection;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+using System.Security.Cryptography;
+using System.Text;
+using System.Threading;
+using VCSFramework;
+
+namespace VCSCompiler
+{
+    /// <summary>Finds the source of a <see cref="RomData{T}"/> field and produces the bytes that go into ROM for it.</summary>
+    internal static class RomDataUtilities
+    {
+        // Bump this if the way generator output is hashed or stored changes, so stale cache files are ignored.
+        private const int CacheVersion = 2;
+        // Serialization lives in the compiler and element types in VCSFramework, so a different build of either also invalidates cache files.
+        private static readonly string BuildVersion = $"{typeof(RomDataUtilities).Assembly.ManifestModule.ModuleVersionId} {typeof(RomData<>).Assembly.ManifestModule.ModuleVersionId}";
+        // Once the cache holds this many bytes it's cleared, since a long-running batch or watch can see many versions of the same data.
+        private const long MaxCachedBytes = 16 * 1024 * 1024;
+        // Keyed by content hash for generators, or by path+timestamp for files. Shared across compilations in the same process.
+        private static readonly ConcurrentDictionary<string, ImmutableArray<byte>> Cache = new();
+        private static long CachedBytes;
+        private static readonly MethodInfo SerializeElementsMethod = typeof(RomDataUtilities).GetMethod(nameof(SerializeElements), BindingFlags.NonPublic | BindingFlags.Static)!;
+
+        public static RomDataGlobalLabel LabelOf(FieldDefinition field)
+        {
+            if (field.TryGetFrameworkAttribute<RomDataFileAttribute>(out var _))
+            {
+                if (field.TryGetFrameworkAttribute<RomDataGeneratorAttribute>(out var _))
+                    throw new InvalidOperationException($"Field '{field.FullName}' can't have both a {nameof(RomDataFileAttribute)} and a {nameof(RomDataGeneratorAttribute)}.");
+                return new RomDataFileGlobalLabel(field);
+            }
+            return new RomDataGeneratorGlobalLabel(GetGeneratorMethod(field));
+        }
+
+        public static int LengthOf(AssemblyPair userPair, FieldDefinition field)
+        {
+            var length = BytesOf(userPair, LabelOf(field)).Length / StrideOf(userPair.Definition, field);
+            // @TODO - 16-bit length/index type.
+            if (length > byte.MaxValue)
+                throw new InvalidOperationException($"RomData field '{field.FullName}' has {length} elements, but Length can be at most {byte.MaxValue}.");
+            return length;
+        }
+
+        public static int StrideOf(AssemblyDefinition userAssembly, FieldDefinition field)
+            => TypeData.Of(((GenericInstanceType)field.FieldType).GenericArguments.Single(), userAssembly).Size;
+
+        public static ImmutableArray<byte> BytesOf(AssemblyPair userPair, RomDataGlobalLabel label) => label switch
+        {
+            RomDataGeneratorGlobalLabel generator => BytesFromGenerator(userPair, generator.GeneratorMethod),
+            RomDataFileGlobalLabel file => BytesFromFile(userPair, file),
+            _ => throw new ArgumentException($"Unknown RomData label type: {label.GetType().Name}")
+        };
+
+        public static MethodDef GetGeneratorMethod(FieldDefinition field)
+        {
+            if (field.TryGetFrameworkAttribute<RomDataGeneratorAttribute>(out var attribute))
+            {
+                var methodName = attribute.MethodName;
+                var expectedArg = ((GenericInstanceType)field.FieldType).GenericArguments.Single();
+                var matchingMethods = field.DeclaringType.Methods.Concat(field.DeclaringType.DeclaringType?.Methods ?? Enumerable.Empty<MethodDefinition>())
+                    .Where(m => m.IsStatic)
+                    .Where(m => m.Name == methodName)
+                    .Where(m => !m.Parameters.Any())
+                    .Where(m => m.ReturnType is GenericInstanceType)
+                    .Where(m => ((GenericInstanceType)m.ReturnType).GenericArguments.SingleOrDefault()?.FullName == expectedArg.FullName)
+                    .Where(m => ((GenericInstanceType)m.ReturnType).ElementType.FullName == BuiltInDefinitions.IEnumerable.FullName)
+                    .ToImmutableArray();
+                var expectedMethod = $"static IEnumerable<{expectedArg.Name}> {methodName}() {{ /** ... */ }}";
+                // ReturnType.GenericArguments should equal field's argument
+                // ReturnType.ElementType == IEnumerable`1
+                return matchingMethods.Length switch
+                {
+                    0 => throw new InvalidOperationException($"No matching RomData generator method found for field '{field.FullName}'. Expected a method on type '{field.DeclaringType.FullName}' that matches: '{expectedMethod}'"),
+                    1 => matchingMethods.Single(),
+                    _ => throw new InvalidOperationException($"Multiple RomData generators found for field '{field.FullName}'. There should only be 1 match. Matches:{Environment.NewLine}{string.Join(Environment.NewLine, matchingMethods.Select(m => m.FullName))}")
+                };
+            }
+            else
+            {
+                throw new InvalidOperationException($"Field '{field.FullName}' must be tagged with a {nameof(RomDataGeneratorAttribute)} or {nameof(RomDataFileAttribute)} in order to be used as a RomData.");
+            }
+        }
+
+        private static ImmutableArray<byte> BytesFromGenerator(AssemblyPair userPair, MethodDefinition generator)
+        {
+            var key = HashGenerator(userPair, generator);
+            return GetOrAddCached(key, () =>
+            {
+                var cachePath = Compiler.Options.RomDataCachePath != null ? Path.Combine(Compiler.Options.RomDataCachePath, $"{key}.bin") : null;
+                if (cachePath != null && File.Exists(cachePath))
+                    return File.ReadAllBytes(cachePath).ToImmutableArray();
+
+                var bytes = RunGenerator(userPair, generator);
+                if (cachePath != null)
+                {
+                    try
+                    {
+                        // Write then move so a concurrent or interrupted build never sees a partial file.
+                        Directory.CreateDirectory(Path.GetDirectoryName(cachePath)!);
+                        var tempPath = $"{cachePath}.{Guid.NewGuid():N}.tmp";
+                        File.WriteAllBytes(tempPath, bytes.ToArray());
+                        File.Move(tempPath, cachePath, true);
+                    }
+                    catch (Exception e) when (e is IOException || e is UnauthorizedAccessException)
+                    {
+                        Compiler.Options.Log.WriteLine($"Failed to write RomData cache file '{cachePath}' because: {e.Message}");
+                    }
+                }
+                return bytes;
+            });
+        }
+
+        private static ImmutableArray<byte> GetOrAddCached(string key, Func<ImmutableArray<byte>> createBytes)
+        {
+            if (Cache.TryGetValue(key, out var cached))
+                return cached;
+
+            var bytes = createBytes();
+            if (Interlocked.Add(ref CachedBytes, bytes.Length) > MaxCachedBytes)
+            {
+                Cache.Clear();
+                Interlocked.Exchange(ref CachedBytes, bytes.Length);
+            }
+            return Cache.GetOrAdd(key, bytes);
+        }
+
+        private static ImmutableArray<byte> RunGenerator(AssemblyPair userPair, MethodDefinition generator)
+        {
+            var compiledMethod = userPair.Assembly.ResolveRomDataGenerator(generator);
+            var elements = compiledMethod.Invoke(null, null) ?? throw new InvalidOperationException($"Return value of RomData generator '{generator.FullName}' was NULL.");
+            var elementType = compiledMethod.ReturnType.GetGenericArguments().Single();
+            var elementTypeData = TypeData.Of(((GenericInstanceType)generator.ReturnType).GenericArguments.Single(), userPair.Definition);
+            return (ImmutableArray<byte>)SerializeElementsMethod.MakeGenericMethod(elementType).Invoke(null, new[] { elements, elementTypeData, userPair.Definition })!;
+        }
+
+        /// <summary>
+        /// Copies every element into a single buffer at once, instead of marshaling them one at a time.
+        /// That's only valid if the managed layout has no padding, otherwise each field is written at its <see cref="TypeData"/> offset.
+        /// </summary>
+        private static ImmutableArray<byte> SerializeElements<T>(IEnumerable<T> elements, TypeData typeData, AssemblyDefinition userAssembly) where T : unmanaged
+        {
+            var array = elements as T[] ?? elements.ToArray();
+            if (Unsafe.SizeOf<T>() == typeData.Size && !typeof(T).IsAutoLayout)
+                return MemoryMarshal.AsBytes(array.AsSpan()).ToArray().ToImmutableArray();
+
+            var buffer = new byte[array.Length * typeData.Size];
+            for (var i = 0; i < array.Length; i++)
+                SerializeValue(array[i], typeData, userAssembly, buffer.AsSpan(i * typeData.Size, typeData.Size));
+            return buffer.ToImmutableArray();
+        }
+
+        private static void SerializeValue(object value, TypeData typeData, AssemblyDefinition userAssembly, Span<byte> destination)
+        {
+            var instanceFields = typeData.Fields.Where(f => !f.Field.IsStatic).ToImmutableArray();
+            if (instanceFields.IsEmpty)
+            {
+                // Multi-byte values are stored LSB first, same as 16-bit globals.
+                switch (value)
+                {
+                    case byte b: destination[0] = b; break;
+                    case bool b: destination[0] = (byte)(b ? 1 : 0); break;
+                    case ushort u: destination[0] = (byte)u; destination[1] = (byte)(u >> 8); break;
+                    case short s: destination[0] = (byte)s; destination[1] = (byte)(s >> 8); break;
+                    default: throw new ArgumentException($"No support for serializing RomData values of type '{value.GetType()}'");
+                }
+                return;
+            }
+
+            foreach (var field in instanceFields)
+            {
+                var fieldInfo = value.GetType().GetField(field.Field.Name, BindingFlags.Instance | BindingFlags.Public | BindingFlags.NonPublic)
+                    ?? throw new InvalidOperationException($"Could not find field '{field.Field.Name}' on '{value.GetType()}'.");
+                var fieldTypeData = TypeData.Of(field.FieldType, userAssembly);
+                SerializeValue(fieldInfo.GetValue(value)!, fieldTypeData, userAssembly, destination.Slice(field.Offset, fieldTypeData.Size));
+            }
+        }
+
+        private static ImmutableArray<byte> BytesFromFile(AssemblyPair userPair, RomDataFileGlobalLabel label)
+        {
+            var field = (FieldDefinition)label.Field.Field;
+            field.TryGetFrameworkAttribute<RomDataFileAttribute>(out var attribute);
+            var path = Path.GetFullPath(attribute!.Path, SourceDirectoryOf(userPair, field));
+            var info = new FileInfo(path);
+            if (!info.Exists)
+                throw new FileNotFoundException($"RomData file for field '{field.FullName}' does not exist.", path);
+
+            var bytes = GetOrAddCached($"file:{path}:{info.Length}:{info.LastWriteTimeUtc.Ticks}", () =>
+            {
+                // Memory mapping can't handle empty files.
+                if (info.Length == 0)
+                    return ImmutableArray<byte>.Empty;
+                using var file = MemoryMappedFile.CreateFromFile(path, FileMode.Open, null, 0, MemoryMappedFileAccess.Read);
+                using var view = file.CreateViewAccessor(0, info.Length, MemoryMappedFileAccess.Read);
+                var buffer = new byte[info.Length];
+                view.ReadArray(0, buffer, 0, buffer.Length);
+                return buffer.ToImmutableArray();
+            });
+
+            var stride = StrideOf(userPair.Definition, field);
+            if (bytes.Length % stride != 0)
+                throw new InvalidOperationException($"RomData file '{path}' for field '{field.FullName}' is {bytes.Length} bytes, which is not a multiple of the element size ({stride}).");
+            return bytes;
+        }
+
+        /// <summary>Directory of the source file that declares the field, which is what <see cref="RomDataFileAttribute"/> paths are relative to.</summary>
+        private static string SourceDirectoryOf(AssemblyPair userPair, FieldDefinition field)
+        {
+            // Roslyn separates nested types with '+', Cecil with '/'.
+            var typeSymbol = userPair.Compilation.GetTypeByMetadataName(field.DeclaringType.FullName.Replace('/', '+'))
+                ?? throw new InvalidOperationException($"Could not find the declaring type of RomData field '{field.FullName}'.");
+            var syntaxTree = typeSymbol.GetMembers(field.Name).Single().DeclaringSyntaxReferences.First().SyntaxTree;
+            return Path.GetDirectoryName(Path.GetFullPath(syntaxTree.FilePath))!;
+        }
+
+        /// <summary>
+        /// Hashes everything that can affect a generator's output: the generator's IL, the IL of every user method it
+        /// (transitively) calls or constructs, static constructors of types whose statics it reads, and the layout of the element type.
+        /// Generators are assumed to be deterministic. One that reads files, the clock, etc. needs the cache disabled.
+        /// </summary>
+        private static string HashGenerator(AssemblyPair userPair, MethodDefinition generator)
+        {
+            var builder = new StringBuilder();
+            var visited = new HashSet<string>();
+            builder.AppendLine($"v{CacheVersion} {BuildVersion}");
+            AppendLayout(((GenericInstanceType)generator.ReturnType).GenericArguments.Single());
+            AppendStaticConstructor(generator.DeclaringType);
+            AppendMethod(generator);
+
+            using var sha = SHA256.Create();
+            return Convert.ToHexString(sha.ComputeHash(Encoding.UTF8.GetBytes(builder.ToString())));
+
+            void AppendMethod(MethodDefinition method)
+            {
+                if (!visited.Add(method.FullName))
+                    return;
+                builder.AppendLine(method.FullName);
+                if (!method.HasBody)
+                    return;
+                foreach (var instruction in method.Body.Instructions)
+                {
+                    // Includes operands, e.g. the full name of a called method or the value of a string.
+                    builder.AppendLine(instruction.ToString());
+                    switch (instruction.Operand)
+                    {
+                        case MethodReference methodReference when IsUserType(methodReference.DeclaringType):
+                            var calledMethod = methodReference.Resolve();
+                            AppendMethod(calledMethod);
+                            // Iterators and lambdas live on compiler-generated types whose methods are never called directly.
+                            if (instruction.OpCode.Code == Code.Newobj)
+                                foreach (var typeMethod in calledMethod.DeclaringType.Methods)
+                                    AppendMethod(typeMethod);
+                            break;
+                        case FieldReference fieldReference when IsUserType(fieldReference.DeclaringType)
+                            && (instruction.OpCode.Code == Code.Ldsfld || instruction.OpCode.Code == Code.Ldsflda):
+                            AppendStaticConstructor(fieldReference.DeclaringType.Resolve());
+                            break;
+                    }
+                }
+            }
+
+            void AppendStaticConstructor(TypeDefinition type)
+            {
+                var staticConstructor = type.Methods.SingleOrDefault(m => m.IsConstructor && m.IsStatic);
+                if (staticConstructor != null)
+                    AppendMethod(staticConstructor);
+            }
+
+            void AppendLayout(TypeReference type)
+            {
+                builder.AppendLine(type.FullName);
+                if (!IsUserType(type) || !visited.Add($"layout:{type.FullName}"))
+                    return;
+                // [StructLayout] and [FieldOffset] change where each field's bytes end up.
+                var typeDefinition = type.Resolve();
+                builder.AppendLine($"{typeDefinition.Attributes & Mono.Cecil.TypeAttributes.LayoutMask} {typeDefinition.PackingSize} {typeDefinition.ClassSize}");
+                foreach (var field in typeDefinition.InstanceFields())
+                {
+                    builder.AppendLine($"{field.Name} {field.Offset}");
+                    AppendLayout(field.FieldType);
+                }
+            }
+
+            bool IsUserType(TypeReference type) => type.Scope == userPair.Definition.MainModule;
+        }
+    }
+}
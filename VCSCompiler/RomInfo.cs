@@ -8,5 +8,6 @@ namespace VCSCompiler
         public string? RomPath { get; init; }
         public string? AssemblyPath { get; init; }
         public string? ListPath { get; init; }
+        public CompilationStatistics Statistics { get; init; } = new();
     }
 }
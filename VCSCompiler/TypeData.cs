@@ -20,6 +20,10 @@ namespace VCSCompiler
 
         public static TypeData Nothing { get; } = new(0, ImmutableArray<TypeData.FieldData>.Empty);
 
+        public static TypeData UInt16 { get; } = new(2, ImmutableArray<TypeData.FieldData>.Empty);
+
+        public static TypeData Int16 { get; } = new(2, ImmutableArray<TypeData.FieldData>.Empty);
+
         public static TypeData Of(TypeDefinition type, ImmutableArray<TypeReference> genericArgs, AssemblyDefinition userAssembly)
         {
             if (type.Namespace.StartsWith("System"))
@@ -136,6 +140,10 @@ namespace VCSCompiler
                 return Byte;
             else if (type.FullName == typeof(bool).FullName)
                 return Bool;
+            else if (type.FullName == typeof(ushort).FullName)
+                return UInt16;
+            else if (type.FullName == typeof(short).FullName)
+                return Int16;
             else
                 throw new ArgumentException($"No support for System type: '{type.FullName}'");
         }
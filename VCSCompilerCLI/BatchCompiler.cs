@@ -0,0 +1,119 @@
+﻿#nullable enable
+using System;
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.Diagnostics;
+using System.IO;
+using System.Linq;
+using System.Text;
+using System.Text.Json;
+using System.Threading.Tasks;
+using VCSCompiler;
+
+namespace VCSCompilerCLI
+{
+    internal sealed record BatchResult
+    {
+        public string Name { get; init; } = "";
+        public bool IsSuccessful { get; init; }
+        public string? RomPath { get; init; }
+        public int RomBytes { get; init; }
+        public int RamBytes { get; init; }
+        public double TotalMilliseconds { get; init; }
+        public Dictionary<string, double> PhaseMilliseconds { get; init; } = new();
+        /// <summary>Everything the compiler and assembler printed for this ROM.</summary>
+        public string Log { get; init; } = "";
+    }
+
+    /// <summary>
+    /// Compiles every job in a <see cref="BatchManifest"/> concurrently in this process, so process startup, Roslyn,
+    /// and the framework metadata are only loaded once. Assembly itself is serialized by the compiler, and the assembler
+    /// still parses vil.h for every ROM.
+    /// </summary>
+    internal static class BatchCompiler
+    {
+        private static readonly JsonSerializerOptions JsonOptions = new() { WriteIndented = true };
+
+        public static int Run(string manifestPath, int? maxParallelism, string? summaryPath)
+        {
+            var jobs = BatchManifest.Load(manifestPath).CreateJobs(manifestPath);
+            foreach (var directory in jobs.Select(j => Path.GetDirectoryName(j.Options.OutputPath)!).Distinct())
+                Directory.CreateDirectory(directory);
+
+            var totalStopwatch = Stopwatch.StartNew();
+            Compiler.WarmUp();
+            var warmUpTime = totalStopwatch.Elapsed;
+
+            var results = new BatchResult[jobs.Length];
+            var parallelOptions = new ParallelOptions { MaxDegreeOfParallelism = maxParallelism ?? Environment.ProcessorCount };
+            Parallel.For(0, jobs.Length, parallelOptions, i => results[i] = Compile(jobs[i]));
+            totalStopwatch.Stop();
+
+            Console.WriteLine(FormatSummary(results, warmUpTime, totalStopwatch.Elapsed));
+            if (summaryPath != null)
+                File.WriteAllText(summaryPath, JsonSerializer.Serialize(results, JsonOptions));
+
+            return results.All(r => r.IsSuccessful) ? 0 : 1;
+        }
+
+        private static BatchResult Compile(BatchJob job)
+        {
+            using var log = new StringWriter();
+            var options = new CompilerOptions
+            {
+                OutputPath = job.Options.OutputPath,
+                DisableOptimizations = job.Options.DisableOptimizations,
+                SourceAnnotations = job.Options.SourceAnnotations,
+                MathStrategy = job.Options.MathStrategy,
+                RomDataCachePath = job.Options.RomDataCachePath,
+                PreprocessorSymbols = job.Options.PreprocessorSymbols,
+                Log = log
+            };
+
+            var stopwatch = Stopwatch.StartNew();
+            RomInfo romInfo;
+            try
+            {
+                romInfo = Compiler.CompileFromFiles(job.SourcePaths, options);
+            }
+            catch (Exception e)
+            {
+                log.WriteLine($"Compiling '{job.Name}' threw: {e}");
+                romInfo = new RomInfo { IsSuccessful = false };
+            }
+            stopwatch.Stop();
+
+            return new BatchResult
+            {
+                Name = job.Name,
+                IsSuccessful = romInfo.IsSuccessful,
+                RomPath = romInfo.RomPath,
+                RomBytes = romInfo.Statistics.RomBytes,
+                RamBytes = romInfo.Statistics.RamBytes,
+                TotalMilliseconds = Math.Round(stopwatch.Elapsed.TotalMilliseconds, 1),
+                PhaseMilliseconds = romInfo.Statistics.PhaseTimes.ToDictionary(p => p.Phase, p => Math.Round(p.Time.TotalMilliseconds, 1)),
+                Log = log.ToString()
+            };
+        }
+
+        private static string FormatSummary(IReadOnlyList<BatchResult> results, TimeSpan warmUpTime, TimeSpan totalTime)
+        {
+            var builder = new StringBuilder();
+            foreach (var failure in results.Where(r => !r.IsSuccessful))
+            {
+                builder.AppendLine($"Output of failed ROM '{failure.Name}':");
+                builder.AppendLine(failure.Log);
+            }
+
+            builder.AppendLine($"{"ROM",-40} {"Result",8} {"ROM",8} {"RAM",6} {"ms",10}");
+            foreach (var result in results)
+            {
+                builder.AppendLine($"{result.Name,-40} {(result.IsSuccessful ? "OK" : "FAILED"),8} {result.RomBytes,8} {result.RamBytes,6} {result.TotalMilliseconds,10}");
+                if (result.PhaseMilliseconds.Any())
+                    builder.AppendLine($"    {string.Join(", ", result.PhaseMilliseconds.Select(p => $"{p.Key}={p.Value}ms"))}");
+            }
+            builder.AppendLine($"{results.Count(r => r.IsSuccessful)}/{results.Count} succeeded. Warm-up {Math.Round(warmUpTime.TotalMilliseconds, 1)}ms, total {Math.Round(totalTime.TotalMilliseconds, 1)}ms.");
+            return builder.ToString();
+        }
+    }
+}
@@ -0,0 +1,120 @@
+﻿#nullable enable
+using System;
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.IO;
+using System.Linq;
+using System.Text.Json;
+using System.Text.Json.Serialization;
+using VCSCompiler;
+
+namespace VCSCompilerCLI
+{
+    /// <summary>
+    /// Describes a batch build: a set of programs, each compiled once per option set.
+    /// Relative paths are resolved against the directory containing the manifest.
+    /// </summary>
+    /// <example>
+    /// {
+    ///   "outputDirectory": "roms",
+    ///   "defaults": { "mathStrategy": "Speed", "romDataCachePath": "cache" },
+    ///   "optionSets": [
+    ///     { "name": "ntsc", "defines": [ "NTSC" ] },
+    ///     { "name": "pal", "defines": [ "PAL" ] }
+    ///   ],
+    ///   "programs": [
+    ///     { "name": "Game", "sources": [ "Game.cs", "Kernel.cs" ] },
+    ///     { "name": "Demo", "sources": [ "Demo.cs" ], "optionSets": [ "ntsc" ] }
+    ///   ]
+    /// }
+    /// </example>
+    internal sealed record BatchManifest
+    {
+        private static readonly JsonSerializerOptions JsonOptions = new()
+        {
+            PropertyNameCaseInsensitive = true,
+            ReadCommentHandling = JsonCommentHandling.Skip,
+            AllowTrailingCommas = true,
+            Converters = { new JsonStringEnumConverter() }
+        };
+
+        /// <summary>Where ROMs are written, as {program}.{optionSet}.bin. Defaults to the manifest's directory.</summary>
+        public string? OutputDirectory { get; init; }
+        /// <summary>Options applied to every option set, unless the set overrides them.</summary>
+        public BatchOptionSet Defaults { get; init; } = new();
+        /// <summary>If empty, every program is compiled once with just <see cref="Defaults"/>.</summary>
+        public List<BatchOptionSet> OptionSets { get; init; } = new();
+        public List<BatchProgram> Programs { get; init; } = new();
+
+        public static BatchManifest Load(string path)
+            => JsonSerializer.Deserialize<BatchManifest>(File.ReadAllText(path), JsonOptions)
+            ?? throw new ArgumentException($"Manifest '{path}' is empty.");
+
+        /// <summary>Expands the manifest into one job per program and option set.</summary>
+        public ImmutableArray<BatchJob> CreateJobs(string manifestPath)
+        {
+            var baseDirectory = Path.GetDirectoryName(Path.GetFullPath(manifestPath))!;
+            var outputDirectory = Path.GetFullPath(OutputDirectory ?? ".", baseDirectory);
+            var optionSets = OptionSets.Any() ? OptionSets : new List<BatchOptionSet> { new() { Name = "default" } };
+
+            var duplicateSet = optionSets.GroupBy(s => s.Name).FirstOrDefault(g => g.Count() > 1);
+            if (duplicateSet != null)
+                throw new ArgumentException($"Option set name '{duplicateSet.Key}' is used more than once.");
+            var duplicateProgram = Programs.GroupBy(p => p.Name).FirstOrDefault(g => g.Count() > 1);
+            if (duplicateProgram != null)
+                throw new ArgumentException($"Program name '{duplicateProgram.Key}' is used more than once.");
+
+            return Programs.SelectMany(program =>
+            {
+                if (!program.Sources.Any())
+                    throw new ArgumentException($"Program '{program.Name}' has no sources.");
+                var unknownSet = program.OptionSets?.FirstOrDefault(name => !optionSets.Any(s => s.Name == name));
+                if (unknownSet != null)
+                    throw new ArgumentException($"Program '{program.Name}' references unknown option set '{unknownSet}'.");
+
+                return optionSets
+                    .Where(set => program.OptionSets == null || program.OptionSets.Contains(set.Name))
+                    .Select(set => new BatchJob(
+                        $"{program.Name}.{set.Name}",
+                        program.Sources.Select(source => Path.GetFullPath(source, baseDirectory)).ToImmutableArray(),
+                        set.CreateCompilerOptions(Defaults, Path.Combine(outputDirectory, $"{program.Name}.{set.Name}.bin"), baseDirectory)));
+            }).ToImmutableArray();
+        }
+    }
+
+    internal sealed record BatchProgram
+    {
+        public string Name { get; init; } = "";
+        public List<string> Sources { get; init; } = new();
+        /// <summary>Names of the option sets to build this program with. If null, all of them are used.</summary>
+        public List<string>? OptionSets { get; init; }
+    }
+
+    /// <summary>A named set of <see cref="CompilerOptions"/>. Null properties fall back to the manifest defaults.</summary>
+    internal sealed record BatchOptionSet
+    {
+        public string Name { get; init; } = "";
+        public bool? DisableOptimizations { get; init; }
+        public SourceAnnotation? SourceAnnotations { get; init; }
+        public MathStrategy? MathStrategy { get; init; }
+        public string? RomDataCachePath { get; init; }
+        /// <summary>Preprocessor symbols. Combined with the defaults' symbols rather than replacing them.</summary>
+        public List<string> Defines { get; init; } = new();
+
+        public CompilerOptions CreateCompilerOptions(BatchOptionSet defaults, string outputPath, string baseDirectory)
+        {
+            var romDataCachePath = RomDataCachePath ?? defaults.RomDataCachePath;
+            return new CompilerOptions
+            {
+                OutputPath = outputPath,
+                DisableOptimizations = DisableOptimizations ?? defaults.DisableOptimizations ?? false,
+                SourceAnnotations = SourceAnnotations ?? defaults.SourceAnnotations ?? SourceAnnotation.CSharp,
+                MathStrategy = MathStrategy ?? defaults.MathStrategy ?? VCSCompiler.MathStrategy.Size,
+                RomDataCachePath = romDataCachePath != null ? Path.GetFullPath(romDataCachePath, baseDirectory) : null,
+                PreprocessorSymbols = defaults.Defines.Concat(Defines).Distinct().ToImmutableArray()
+            };
+        }
+    }
+
+    internal sealed record BatchJob(string Name, ImmutableArray<string> SourcePaths, CompilerOptions Options);
+}
@@ -1,5 +1,6 @@
 ﻿#nullable enable
 using System;
+using System.Collections.Immutable;
 using System.Linq;
 using System.Text;
 using VCSCompiler;
@@ -11,7 +12,7 @@ namespace VCSCompilerCLI
 		/// <summary>
 		/// A compiler that compiles C# source code into a VCS (Atari 2600) binary.
 		/// </summary>
-		/// <param name="arguments">A list of C# source files to compile.</param>
+		/// <param name="arguments">A list of C# source files to compile into a single ROM.</param>
 		/// <param name="outputPath">The path to save the compiled binary to. The same path with a different extension will be used for related files.
 		/// If a path is not provided, temp files will be used.</param>
 		/// <param name="emulatorPath">Path of the emulator executable. 
@@ -22,25 +23,51 @@ namespace VCSCompilerCLI
 		/// VIL macros and stack operations. Unoptimized code generally will not run correctly due to excessive cycles consumed.</param>
 		/// <param name="sourceAnnotations">Whether to include C#, CIL, neither, or both source lines as comments
 		/// above the VIL macros that they were compiled to.</param>
+		/// <param name="mathStrategy">Whether multiplication and division of two variables should favor ROM size (loops)
+		/// or speed (lookup tables and unrolled loops).</param>
+		/// <param name="romDataCachePath">Directory to cache RomData generator output in between builds.
+		/// If not provided, generators run on every build.</param>
+		/// <param name="defines">Preprocessor symbols to define when compiling the C# source.</param>
+		/// <param name="manifest">Path of a JSON batch manifest listing programs and option sets. If provided, every
+		/// program is compiled with every option set concurrently in this process, and all other options are ignored.</param>
+		/// <param name="maxParallelism">Maximum number of ROMs to compile at once in batch mode. Defaults to the number of processors.</param>
+		/// <param name="summaryPath">If provided in batch mode, per-ROM results and timings are also written here as JSON.</param>
 		static int Main(
 			string[] arguments,
 			string? outputPath = null,
 			string? emulatorPath = null,
 			string? textEditorPath = null,
 			bool disableOptimizations = false,
-			SourceAnnotation sourceAnnotations = SourceAnnotation.CSharp
+			SourceAnnotation sourceAnnotations = SourceAnnotation.CSharp,
+			MathStrategy mathStrategy = MathStrategy.Size,
+			string? romDataCachePath = null,
+			string[]? defines = null,
+			string? manifest = null,
+			int? maxParallelism = null,
+			string? summaryPath = null
 			)
         {
+			if (manifest != null)
+			{
+				return BatchCompiler.Run(manifest, maxParallelism, summaryPath);
+			}
+
 			var options = new CompilerOptions
 			{
 				OutputPath = outputPath,
 				EmulatorPath = emulatorPath,
 				TextEditorPath = textEditorPath,
 				DisableOptimizations = disableOptimizations,
-				SourceAnnotations = sourceAnnotations
+				SourceAnnotations = sourceAnnotations,
+				MathStrategy = mathStrategy,
+				RomDataCachePath = romDataCachePath,
+				PreprocessorSymbols = defines?.ToImmutableArray() ?? ImmutableArray<string>.Empty
 			};
-			var file = arguments.SingleOrDefault() ?? throw new ArgumentException("Missing file");
-			var result = Compiler.CompileFromFile(file, options);
+			if (!arguments.Any())
+			{
+				throw new ArgumentException("Missing file");
+			}
+			var result = Compiler.CompileFromFiles(arguments, options);
 			var builder = new StringBuilder();
 			builder.AppendLine($"  {nameof(RomInfo.IsSuccessful)}: {result.IsSuccessful}");
 			builder.AppendLine($"  {nameof(RomInfo.RomPath)}: {result.RomPath}");
@@ -71,7 +71,21 @@ namespace VCSFramework
     public sealed record ReservedGlobalLabel(int Index) : IGlobalLabel;
     public sealed record ReturnValueGlobalLabel(MethodDef Method) : IGlobalLabel;
     /// <summary>Label to a readonly global located in ROM. May be a single value or the first element of multiple values.</summary>
-    public sealed record RomDataGlobalLabel(MethodDef GeneratorMethod) : IGlobalLabel;
+    public abstract record RomDataGlobalLabel : IGlobalLabel
+    {
+        /// <summary>The type argument of the RomData&lt;T&gt; this data belongs to.</summary>
+        public abstract TypeRef ElementType { get; }
+    }
+    /// <summary>RomData produced by a generator method. Every field using the same generator shares the same data.</summary>
+    public sealed record RomDataGeneratorGlobalLabel(MethodDef GeneratorMethod) : RomDataGlobalLabel
+    {
+        public override TypeRef ElementType => ((GenericInstanceType)GeneratorMethod.Method.ReturnType).GenericArguments[0];
+    }
+    /// <summary>RomData read straight out of a binary file.</summary>
+    public sealed record RomDataFileGlobalLabel(FieldRef Field) : RomDataGlobalLabel
+    {
+        public override TypeRef ElementType => ((GenericInstanceType)Field.Type).GenericArguments[0];
+    }
     public sealed record ThisPointerGlobalLabel(MethodDef Method) : IGlobalLabel;
     public sealed record TypeSizeLabel(TypeRef Type) : ISizeLabel;
     public sealed record TypeLabel(TypeRef Type) : ITypeLabel;
@@ -79,6 +93,7 @@ namespace VCSFramework
 
     #region PseudoOps
     public interface IPseudoOp : IAssemblyEntry { }
+    public sealed record AlignOp(int Boundary) : IPseudoOp;
     public sealed record ArrayLetOp(string VariableName, ImmutableArray<IExpression> Elements) : IPseudoOp;
     public sealed record BeginBlock() : IPseudoOp;
     public sealed record ByteOp(ImmutableArray<byte> Bytes) : IPseudoOp;
@@ -38,7 +38,9 @@ namespace VCSFramework
 
     /// <summary>
     /// Replaces invocations of this method with the provided <see cref="IAssemblyEntry"/>, instead of a macro invocation.
-    /// Type must have a constructor that takes a single <see cref="Mono.Cecil.Cil.Instruction"/> as the only parameter.
+    /// Type must have a constructor that takes a single <see cref="Mono.Cecil.Cil.Instruction"/> as the only parameter,
+    /// or be a macro whose other parameters are the types/sizes of stack operands (e.g. <see cref="AddFromStack"/>).
+    /// The method's arguments are those operands, with the last argument on top of the stack.
     /// </summary>
     [AttributeUsage(AttributeTargets.Method, AllowMultiple = false)]
     public sealed class ReplaceWithEntryAttribute : Attribute
@@ -73,6 +75,22 @@ namespace VCSFramework
         }
     }
 
+    /// <summary>
+    /// Fills a <see cref="RomData{T}"/> field with the raw contents of a binary file, instead of running a generator method.
+    /// Relative paths are resolved from the directory of the source file being compiled. The file's length must be
+    /// a multiple of the size of the element type.
+    /// </summary>
+    [AttributeUsage(AttributeTargets.Field, AllowMultiple = false)]
+    public sealed class RomDataFileAttribute : Attribute
+    {
+        public string Path { get; }
+
+        public RomDataFileAttribute(string path)
+        {
+            Path = path;
+        }
+    }
+
     /// <summary>
     /// Instructs compiler to replace all invocations of this method with its body.
     /// </summary>
@@ -21,12 +21,18 @@ namespace VCSFramework
             => Assemblies.SelectMany(a => a.MainModule.Types);
 
         public static IEnumerable<TypeDefinition> Types
-            => new[] { Byte, Bool, Nothing };
+            => new[] { Byte, Bool, Nothing, UInt16, Int16, Fixed8_8 };
 
         public static readonly TypeDefinition Byte = AllTypeDefinitions.Single(t => t.FullName == typeof(byte).FullName);
 
         public static readonly TypeDefinition Bool = AllTypeDefinitions.Single(t => t.FullName == typeof(bool).FullName);
 
+        public static readonly TypeDefinition UInt16 = AllTypeDefinitions.Single(t => t.FullName == typeof(ushort).FullName);
+
+        public static readonly TypeDefinition Int16 = AllTypeDefinitions.Single(t => t.FullName == typeof(short).FullName);
+
+        public static readonly TypeDefinition Fixed8_8 = AllTypeDefinitions.Single(t => t.FullName == typeof(VCSFramework.Fixed8_8).FullName);
+
         public static readonly TypeDefinition IEnumerable = AllTypeDefinitions.Single(t => t.Name == "IEnumerable`1");
 
         public static readonly TypeDefinition Nothing = AllTypeDefinitions.Single(t => t.FullName == typeof(Nothing).FullName);
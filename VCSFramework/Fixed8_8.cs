@@ -0,0 +1,43 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace VCSFramework
+{
+    /// <summary>
+    /// An unsigned 8.8 fixed-point number, for things like sub-pixel positions and velocities.
+    /// <see cref="Integer"/> and <see cref="Fraction"/> overlap <see cref="Raw"/>, so reading the whole-number part
+    /// of a position is just a read of its high byte.
+    /// Arithmetic wraps around like it does for <see cref="ushort"/>, and is done with ADC/SBC carry chains on both bytes.
+    /// </summary>
+    [StructLayout(LayoutKind.Explicit)]
+    public struct Fixed8_8
+    {
+        /// <summary>The value multiplied by 256. Useful for assigning a value that has a fractional part, e.g. 0x0180 for 1.5.</summary>
+        [FieldOffset(0)]
+        public ushort Raw;
+        [FieldOffset(0)]
+        public byte Fraction;
+        [FieldOffset(1)]
+        public byte Integer;
+
+        [ReplaceWithEntry(typeof(AddFromStack))]
+        public static Fixed8_8 operator +(Fixed8_8 left, Fixed8_8 right) => throw new NotImplementedException();
+
+        [ReplaceWithEntry(typeof(SubFromStack))]
+        public static Fixed8_8 operator -(Fixed8_8 left, Fixed8_8 right) => throw new NotImplementedException();
+
+        [ReplaceWithEntry(typeof(CompareLessThanFromStack))]
+        public static bool operator <(Fixed8_8 left, Fixed8_8 right) => throw new NotImplementedException();
+
+        [ReplaceWithEntry(typeof(CompareGreaterThanFromStack))]
+        public static bool operator >(Fixed8_8 left, Fixed8_8 right) => throw new NotImplementedException();
+
+        /// <summary>Creates a value with no fractional part. Constants are converted at compile time.</summary>
+        [ReplaceWithEntry(typeof(ConvertByteToFixedPointFromStack))]
+        public static implicit operator Fixed8_8(byte value) => throw new NotImplementedException();
+
+        /// <summary>Truncates the fractional part. Same as reading <see cref="Integer"/>.</summary>
+        [ReplaceWithEntry(typeof(ConvertFixedPointToByteFromStack))]
+        public static explicit operator byte(Fixed8_8 value) => throw new NotImplementedException();
+    }
+}
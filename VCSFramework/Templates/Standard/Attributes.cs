@@ -122,4 +122,35 @@ namespace VCSFramework.Templates.Standard
     /// </summary>
     [AttributeUsage(AttributeTargets.Method, AllowMultiple = false)]
     public sealed class OverscanAttribute : Attribute { }
+
+    /// <summary>
+    /// Tells the scheduler how expensive a <see cref="VBlankAttribute"/> or <see cref="OverscanAttribute"/> method is and how often it needs to run,
+    /// so work can be spread across frames instead of all running every frame.
+    /// A method marked with this but neither of those attributes is placed in whichever of VBlank or Overscan has more time available.
+    /// Methods without this attribute are treated as free, required, and running every frame.
+    /// Marked methods must return void and take no parameters.
+    /// </summary>
+    [AttributeUsage(AttributeTargets.Method, AllowMultiple = false)]
+    public sealed class ScheduleAttribute : Attribute
+    {
+        public const int MaxPeriod = 64;
+
+        public int EstimatedScanlines { get; }
+        public int Period { get; }
+        public SchedulePriority Priority { get; }
+
+        /// <param name="estimatedScanlines">Worst case time the method takes to run, in scanlines (76 cycles each).</param>
+        /// <param name="period">The method runs once every this many frames. Must be a power of 2, up to <see cref="MaxPeriod"/>.</param>
+        /// <param name="priority">Whether the method must run on its frame, or can be skipped (and retried next frame) if there isn't enough time.</param>
+        public ScheduleAttribute(int estimatedScanlines, int period = 1, SchedulePriority priority = SchedulePriority.Required)
+        {
+            if (estimatedScanlines < 0)
+                throw new ArgumentException($"{nameof(estimatedScanlines)} ({estimatedScanlines}) must not be negative.");
+            if (period < 1 || period > MaxPeriod || (period & (period - 1)) != 0)
+                throw new ArgumentException($"{nameof(period)} ({period}) must be a power of 2 between 1 and {MaxPeriod}.");
+            EstimatedScanlines = estimatedScanlines;
+            Period = period;
+            Priority = priority;
+        }
+    }
 }
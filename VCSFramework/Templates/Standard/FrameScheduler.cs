@@ -0,0 +1,204 @@
+﻿#nullable enable
+using System;
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.Linq;
+using System.Reflection;
+using System.Text;
+
+namespace VCSFramework.Templates.Standard
+{
+    /// <summary>
+    /// Decides which frame and which phase (VBlank or Overscan) each <see cref="VBlankAttribute"/>, <see cref="OverscanAttribute"/>,
+    /// and <see cref="ScheduleAttribute"/> method runs in, and generates the code that invokes them.
+    /// </summary>
+    internal sealed class FrameScheduler
+    {
+        private enum Slot { VBlank, Overscan }
+        private sealed record ScheduledMethod(MethodInfo Method, int Index, Slot? FixedSlot, int TimerTicks, int Period, SchedulePriority Priority);
+        private sealed record Assignment(ScheduledMethod Scheduled, Slot Slot, int Phase);
+
+        // Tim64T values used by StandardTemplate. The timer decrements every 64 cycles.
+        public const int VBlankTimerTicks = 43;
+        public const int OverscanTimerTicks = 35;
+        private const int CyclesPerScanline = 76;
+        private const int CyclesPerTimerTick = 64;
+
+        private readonly Type ProgramType;
+        private readonly int VBlankReservedTimerTicks;
+        private readonly ImmutableArray<Assignment> Assignments;
+
+        /// <param name="vblankReservedTimerTicks">Ticks at the end of VBlank needed by code that runs after all scheduled methods.</param>
+        public FrameScheduler(Type programType, int vblankReservedTimerTicks)
+        {
+            ProgramType = programType;
+            VBlankReservedTimerTicks = vblankReservedTimerTicks;
+            var methodFlags = BindingFlags.Public | BindingFlags.NonPublic | BindingFlags.Static;
+            var methods = programType.GetMethods(methodFlags)
+                .Where(m => HasAttribute<VBlankAttribute>(m) || HasAttribute<OverscanAttribute>(m) || HasAttribute<ScheduleAttribute>(m))
+                .OrderBy(m => m.MetadataToken)
+                .Select((m, i) => CreateScheduledMethod(m, i))
+                .ToImmutableArray();
+            Assignments = Assign(methods);
+            ValidateRequiredTime();
+        }
+
+        public void GenerateCode(out string fieldCode, out string initializationCode, out string vblankCode, out string overscanCode)
+        {
+            var fieldBuilder = new StringBuilder();
+            var initializationBuilder = new StringBuilder();
+            foreach (var assignment in Assignments.Where(a => a.Scheduled.Period > 1))
+            {
+                fieldBuilder.AppendLine($"private static byte {CountdownName(assignment)};");
+                initializationBuilder.AppendLine($"{CountdownName(assignment)} = {assignment.Phase};");
+            }
+            fieldCode = fieldBuilder.ToString();
+            initializationCode = initializationBuilder.ToString();
+            vblankCode = GenerateSlotCode(Slot.VBlank);
+            overscanCode = GenerateSlotCode(Slot.Overscan);
+        }
+
+        private string GenerateSlotCode(Slot slot)
+        {
+            var builder = new StringBuilder();
+            var slotAssignments = Assignments.Where(a => a.Slot == slot).ToImmutableArray();
+            if (!slotAssignments.Any())
+            {
+                builder.AppendLine($"// No user {slot} methods found.");
+                return builder.ToString();
+            }
+
+            builder.AppendLine($"// Invoke required user {slot} methods, in order of declaration:");
+            foreach (var assignment in slotAssignments.Where(a => a.Scheduled.Priority == SchedulePriority.Required))
+                builder.AppendLine(GenerateInvocation(assignment));
+
+            var optional = slotAssignments.Where(a => a.Scheduled.Priority != SchedulePriority.Required)
+                .OrderBy(a => a.Scheduled.Priority)
+                .ThenBy(a => a.Scheduled.Index)
+                .ToImmutableArray();
+            if (optional.Any())
+            {
+                builder.AppendLine($"// Invoke optional user {slot} methods, in order of priority, if there's enough time left:");
+                foreach (var assignment in optional)
+                    builder.AppendLine(GenerateInvocation(assignment));
+            }
+            return builder.ToString();
+        }
+
+        private string GenerateInvocation(Assignment assignment)
+        {
+            var scheduled = assignment.Scheduled;
+            var call = $"{ProgramType.FullName}.{scheduled.Method.Name}();";
+            // One extra tick covers the check itself, plus finishing the phase's WSync.
+            // Written as >= since the compiler doesn't support every comparison branch opcode.
+            var requiredTicks = scheduled.TimerTicks + 1 + (assignment.Slot == Slot.VBlank ? VBlankReservedTimerTicks : 0);
+            var run = scheduled.Priority == SchedulePriority.Required ? call : $"if (InTim >= {requiredTicks}) {{ {call} ";
+            var runEnd = scheduled.Priority == SchedulePriority.Required ? "" : " }";
+            if (scheduled.Period == 1)
+                return $"{run}{runEnd}";
+
+            // Counts down to 0, runs, then resets. An optional method that's skipped stays at 0 so it runs as soon as there's time.
+            var countdown = CountdownName(assignment);
+            return
+$@"if ({countdown} == 0)
+{{
+    {run} {countdown} = {scheduled.Period - 1};{runEnd}
+}}
+else
+{{
+    {countdown}--;
+}}";
+        }
+
+        private void ValidateRequiredTime()
+        {
+            foreach (var slot in new[] { Slot.VBlank, Slot.Overscan })
+            {
+                var budget = Budget(slot);
+                var loads = GetLoads(Assignments.Where(a => a.Scheduled.Priority == SchedulePriority.Required), slot);
+                for (var frame = 0; frame < loads.Length; frame++)
+                {
+                    if (loads[frame] > budget)
+                    {
+                        var methods = Assignments.Where(a => a.Slot == slot && a.Scheduled.Priority == SchedulePriority.Required && frame % a.Scheduled.Period == a.Phase);
+                        throw new InvalidOperationException($"Required {slot} methods need an estimated {loads[frame]} timer ticks on frame {frame}, but only {budget} are available. " +
+                            $"Lower their cost, increase their [{nameof(ScheduleAttribute)}] period, or make some optional: {string.Join(", ", methods.Select(a => a.Scheduled.Method.Name))}");
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Greedily places the most expensive methods first, each into the slot and phase (frame offset within its period)
+        /// that keeps the busiest frame as light as possible.
+        /// </summary>
+        private ImmutableArray<Assignment> Assign(ImmutableArray<ScheduledMethod> methods)
+        {
+            var frameCount = methods.Select(m => m.Period).DefaultIfEmpty(1).Max();
+            var loads = new Dictionary<Slot, int[]>
+            {
+                [Slot.VBlank] = new int[frameCount],
+                [Slot.Overscan] = new int[frameCount]
+            };
+            var assignments = new List<Assignment>();
+
+            foreach (var method in methods.OrderBy(m => m.Priority == SchedulePriority.Required ? 0 : 1).ThenByDescending(m => m.TimerTicks).ThenBy(m => m.Index))
+            {
+                var candidateSlots = method.FixedSlot is Slot fixedSlot ? new[] { fixedSlot } : new[] { Slot.VBlank, Slot.Overscan };
+                var best = candidateSlots
+                    .SelectMany(slot => Enumerable.Range(0, method.Period).Select(phase => (Slot: slot, Phase: phase)))
+                    .Select(c => (c.Slot, c.Phase, Worst: FramesOf(c.Phase, method.Period, frameCount).Max(f => loads[c.Slot][f]) + method.TimerTicks - Budget(c.Slot)))
+                    .OrderBy(c => c.Worst)
+                    .First();
+                foreach (var frame in FramesOf(best.Phase, method.Period, frameCount))
+                    loads[best.Slot][frame] += method.TimerTicks;
+                assignments.Add(new Assignment(method, best.Slot, best.Phase));
+            }
+
+            return assignments.OrderBy(a => a.Scheduled.Index).ToImmutableArray();
+        }
+
+        private int Budget(Slot slot) => slot == Slot.VBlank ? VBlankTimerTicks - VBlankReservedTimerTicks : OverscanTimerTicks;
+
+        private static int[] GetLoads(IEnumerable<Assignment> assignments, Slot slot)
+        {
+            var all = assignments.ToImmutableArray();
+            var frameCount = all.Select(a => a.Scheduled.Period).DefaultIfEmpty(1).Max();
+            var loads = new int[frameCount];
+            foreach (var assignment in all.Where(a => a.Slot == slot))
+                foreach (var frame in FramesOf(assignment.Phase, assignment.Scheduled.Period, frameCount))
+                    loads[frame] += assignment.Scheduled.TimerTicks;
+            return loads;
+        }
+
+        private static IEnumerable<int> FramesOf(int phase, int period, int frameCount)
+        {
+            for (var frame = phase; frame < frameCount; frame += period)
+                yield return frame;
+        }
+
+        private static ScheduledMethod CreateScheduledMethod(MethodInfo method, int index)
+        {
+            if (method.ReturnType != typeof(void) || method.GetParameters().Any())
+                throw new InvalidOperationException($"Method '{method.Name}' must return void and take no parameters to be a VBlank/Overscan method.");
+
+            var isVBlank = HasAttribute<VBlankAttribute>(method);
+            var isOverscan = HasAttribute<OverscanAttribute>(method);
+            if (isVBlank && isOverscan)
+                throw new InvalidOperationException($"Method '{method.Name}' can't be marked with both [{nameof(VBlankAttribute)}] and [{nameof(OverscanAttribute)}]. " +
+                    $"Use only [{nameof(ScheduleAttribute)}] to let the scheduler pick.");
+            Slot? fixedSlot = isVBlank ? Slot.VBlank : isOverscan ? Slot.Overscan : null;
+
+            var schedule = method.GetCustomAttribute<ScheduleAttribute>();
+            if (schedule == null)
+                return new ScheduledMethod(method, index, fixedSlot, 0, 1, SchedulePriority.Required);
+            var timerTicks = (schedule.EstimatedScanlines * CyclesPerScanline + CyclesPerTimerTick - 1) / CyclesPerTimerTick;
+            return new ScheduledMethod(method, index, fixedSlot, timerTicks, schedule.Period, schedule.Priority);
+        }
+
+        private static bool HasAttribute<T>(MethodInfo method) where T : Attribute
+            => method.CustomAttributes.Any(a => a.AttributeType == typeof(T));
+
+        private static string CountdownName(Assignment assignment) => $"ScheduleCountdown_{assignment.Scheduled.Method.Name}";
+    }
+}
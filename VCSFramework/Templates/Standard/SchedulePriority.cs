@@ -0,0 +1,17 @@
+﻿namespace VCSFramework.Templates.Standard
+{
+    public enum SchedulePriority
+    {
+        /// <summary>
+        /// Always runs on its frame. The total estimated cost of required methods on any frame must fit in the VBlank/Overscan time.
+        /// </summary>
+        Required,
+        /// <summary>
+        /// Only starts if INTIM shows enough time left for its estimated cost, otherwise it's retried next frame.
+        /// Optional methods run after required ones, highest priority first.
+        /// </summary>
+        High,
+        Normal,
+        Low,
+    }
+}
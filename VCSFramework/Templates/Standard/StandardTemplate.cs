@@ -8,19 +8,17 @@ namespace VCSFramework.Templates.Standard
 {
     public sealed class StandardTemplate : ProgramTemplate
     {
-        private readonly ImmutableArray<MethodInfo> VBlanks;
         private readonly ImmutableArray<MethodInfo> KernelMethods;
         private readonly MethodInfo Kernel;
 
+        // Kernel initialization is only a register load, well under the 64 cycles of one timer tick.
+        private const int KernelInitializationTimerTicks = 1;
+
         internal override string GeneratedTypeName => "StandardTemplatedProgram";
 
         public StandardTemplate(Type programType) : base(programType)
         {
             var methodFlags = BindingFlags.Public | BindingFlags.NonPublic | BindingFlags.Static;
-            VBlanks = programType.GetMethods(methodFlags)
-                .Where(m => m.CustomAttributes.Any(a => a.AttributeType == typeof(VBlankAttribute)))
-                .ToImmutableArray();
-
             KernelMethods = programType.GetMethods(methodFlags)
                 .Where(m => m.CustomAttributes.Any(a => a.AttributeType == typeof(KernelAttribute)))
                 .ToImmutableArray();
@@ -28,24 +26,16 @@ namespace VCSFramework.Templates.Standard
 
         internal override string GenerateSourceText()
         {
-            var vblankCodeBuilder = new StringBuilder();
-            if (!VBlanks.Any())
-            {
-                vblankCodeBuilder.AppendLine("// No user VBlank methods found.");
-            }
-            else
-            {
-                vblankCodeBuilder.AppendLine($"// Invoke user-provided [{nameof(VBlankAttribute)}] methods, in order of declaration:");
-                foreach (var vblank in VBlanks)
-                {
-                    vblankCodeBuilder.AppendLine($"{ProgramType.FullName}.{vblank.Name}();");
-                }
-            }
-
             // @TODO - Need region param
             var kernelManager = new KernelManager(Region.NTSC, ProgramType);
             kernelManager.GenerateCode(out var kernelCode, out var kernelInitCode);
 
+            // Kernel initialization sets up registers the kernel uses, so it has to run after the user's VBlank methods.
+            // Its time is reserved up front so optional methods can't push it past the end of VBlank.
+            var scheduler = new FrameScheduler(ProgramType, kernelInitCode != null ? KernelInitializationTimerTicks : 0);
+            scheduler.GenerateCode(out var scheduleFieldCode, out var scheduleInitCode, out var vblankCode, out var overscanCode);
+            var vblankCodeBuilder = new StringBuilder(vblankCode);
+
             if (kernelInitCode != null)
             {
                 vblankCodeBuilder.AppendLine();
@@ -63,8 +53,10 @@ using static VCSFramework.AssemblyUtilities;
 
 public static class {GeneratedTypeName}
 {{
+{scheduleFieldCode}
     public static void Main()
     {{
+{scheduleInitCode}
         while (true)
         {{
             // VBlank
@@ -72,7 +64,7 @@ public static class {GeneratedTypeName}
 			WSync();
 			WSync();
 			WSync();
-			Tim64T = 43;
+			Tim64T = {FrameScheduler.VBlankTimerTicks};
 			VSync = 0;
 
 {vblankCodeBuilder}
@@ -93,9 +85,9 @@ public static class {GeneratedTypeName}
             VBlank = 2;
             // Cycles to kill = 30 * 76 - 14 (LDA/STA timer, WSYNC after timer expire, time to check loop) - 5 (LDA/STA VBLANK) - 2 (BNE not taken) = 2259
             // 2259 / 64 = 35.297, round down for timer and a WSYNC afterwards will clean up the remainder.
-            Tim64T = 35;
-            
-            // @TODO - User overscan code goes here.
+            Tim64T = {FrameScheduler.OverscanTimerTicks};
+
+{overscanCode}
             while (TimInt == 0) ;
             WSync();
         }}
@@ -136,21 +136,28 @@ pushDereferenceFromStack .macro pointerStackSize, type, size
 // @GENERATE @RESERVED=2 @POP=1 @PUSH=fieldType;fieldSize
 pushFieldFromStack .macro offsetConstant, fieldType, fieldSize, stackType, stackSize
 	.if isPointer(\stackType) == true
-		.errorif \fieldSize != 1, "Currently, only 1-byte types are allowed for pushFieldFromStack"
 		.if \stackSize == 1
 			PLA
 			TAX
-			LDA \offsetConstant,X
-			PHA
+			.for i = \fieldSize - 1, i >= 0, i = i - 1
+				.let fieldAddress = \offsetConstant + i
+				LDA fieldAddress,X
+				PHA
+			.next
 		.endif
 		.if \stackSize == 2
 			PLA
 			STA INTERNAL_RESERVED_0
 			PLA
 			STA INTERNAL_RESERVED_1
-			LDY \offsetConstant
-			LDA (INTERNAL_RESERVED_0),Y
-			PHA
+			LDY #(\offsetConstant + \fieldSize - 1)
+			.for i = \fieldSize, i > 0, i = i - 1
+				LDA (INTERNAL_RESERVED_0),Y
+				PHA
+				.if i > 1
+					DEY
+				.endif
+			.next
 		.endif
 	.else
 		// Note even if we're only fetching a 1-byte field off a 10-byte instance, we still gotta clear the whole
@@ -171,6 +178,62 @@ pushFieldFromStack .macro offsetConstant, fieldType, fieldSize, stackType, stack
 	.endif
 .endmacro
 
+// @GENERATE @COMPOSITE @PUSH=type;size
+// pushGlobal + pushDereferenceFromStack
+// Dereferences a pointer that already lives in a zero-page global (local, argument, 'this') without round-tripping
+// it through the stack and INTERNAL_RESERVED_0/1. Long pointers use (pointerGlobal),Y directly.
+pushDereferenceFromPointerGlobal .macro pointerGlobal, pointerGlobalSize, type, size
+	.if \pointerGlobalSize == 1
+		LDX \pointerGlobal
+		.for i = \size - 1, i >= 0, i = i - 1
+			LDA i,X
+			PHA
+		.next
+	.endif
+	.if \pointerGlobalSize == 2
+		LDY #(\size-1)
+		.for i = \size, i > 0, i = i - 1
+			LDA (\pointerGlobal),Y
+			PHA
+			.if i > 1
+				DEY
+			.endif
+		.next
+	.endif
+.endmacro
+
+// @GENERATE @COMPOSITE @PUSH=fieldType;fieldSize
+// pushGlobal + pushFieldFromStack
+// Reads a field through a pointer that already lives in a zero-page global. Consecutive reads through the same
+// pointer only need to reload Y (or X for short pointers), rather than popping and storing the pointer every time.
+// If the global holds the instance itself rather than a pointer to it, the field is read directly.
+pushFieldFromPointerGlobal .macro offsetConstant, fieldType, fieldSize, pointerGlobal, pointerGlobalType, pointerGlobalSize
+	.if isPointer(\pointerGlobalType) == false
+		.for i = \fieldSize - 1, i >= 0, i = i - 1
+			LDA \pointerGlobal + \offsetConstant + i
+			PHA
+		.next
+	.endif
+	.if isPointer(\pointerGlobalType) == true && \pointerGlobalSize == 1
+		LDX \pointerGlobal
+		.for i = \fieldSize - 1, i >= 0, i = i - 1
+			.let fieldAddress = \offsetConstant + i
+			LDA fieldAddress,X
+			PHA
+		.next
+	.endif
+	.if isPointer(\pointerGlobalType) == true && \pointerGlobalSize == 2
+		LDY #(\offsetConstant + \fieldSize - 1)
+		.for i = \fieldSize, i > 0, i = i - 1
+			LDA (\pointerGlobal),Y
+			PHA
+			.if i > 1
+				DEY
+			.endif
+		.next
+	.endif
+.endmacro
+
 // @GENERATE @POP=2
 popToFieldFromStack .macro offsetConstant, fieldType, fieldSize, pointerStackType, pointerStackSize
 	.invoke assertIsPointer(\pointerStackType)
@@ -187,7 +250,8 @@ popToFieldFromStack .macro offsetConstant, fieldType, fieldSize, pointerStackTyp
 		TSX // Use stack pointer to skip over value in stack. Remember SP points to NEXT stack location, not current (so add 1).
 		LDA \fieldSize + 1,X
 		TAX // Fetch pointer and store in X.
-		.for i = \fieldSize - 1, i >= 0, i = i - 1
+		// The LSB is on top of the stack, so it goes to the lowest address.
+		.for i = 0, i < \fieldSize, i = i + 1
 			PLA
 			STA \offsetConstant + i,X
 		.next
@@ -228,8 +292,9 @@ popToAddressFromStack .macro type, size
 .endmacro
 
 // @GENERATE @POP=1
-popToRegister .macro registerConstant, stackType
-	.errorif \stackType != TYPE_System_Byte, "Only 'byte's can be directly popped to a register"
+popToRegister .macro registerConstant, stackType, stackSize
+	// Registers also hold enregistered locals, which may be bools, so only the size matters.
+	.errorif \stackSize != 1, "Only 1-byte values can be directly popped to a register"
 	// @TODO @REPORTME - if/elif doesn't work, have to use multiple if instead.
 	.if \registerConstant == 0
 		PLA
@@ -247,6 +312,96 @@ popToRegister .macro registerConstant, stackType
 	.endif
 .endmacro
 
+// The following macros operate on locals the register allocator moved from zero-page into X or Y.
+// registerConstant uses the same indices as popToRegister, only X (1) and Y (2) are valid.
+
+// @GENERATE @PUSH=type;size
+pushRegister .macro registerConstant, type, size
+	.errorif \size != 1, "Only 1-byte values can be held in a register"
+	.if \registerConstant == 1
+		TXA
+	.endif
+	.if \registerConstant == 2
+		TYA
+	.endif
+	.if \registerConstant != 1 && \registerConstant != 2
+		.error format("Unknown index register: {0}", \registerConstant)
+	.endif
+	PHA
+.endmacro
+
+// @GENERATE @COMPOSITE
+// pushConstant + popToRegister
+assignConstantToRegister .macro constant, registerConstant
+	.if \registerConstant == 1
+		LDX #\constant
+	.endif
+	.if \registerConstant == 2
+		LDY #\constant
+	.endif
+.endmacro
+
+// @GENERATE @COMPOSITE
+// pushRegister + pushConstant + addFromStack + popToRegister iff same register AND constant==1
+incrementRegister .macro registerConstant
+	.if \registerConstant == 1
+		INX
+	.endif
+	.if \registerConstant == 2
+		INY
+	.endif
+.endmacro
+
+// @GENERATE @COMPOSITE
+// pushRegister + pushConstant + subFromStack + popToRegister iff same register AND constant==1
+decrementRegister .macro registerConstant
+	.if \registerConstant == 1
+		DEX
+	.endif
+	.if \registerConstant == 2
+		DEY
+	.endif
+.endmacro
+
+// @GENERATE @COMPOSITE
+// pushRegister + pushConstant + branchIfLessThanFromStack
+branchIfRegisterLessThanConstant .macro registerConstant, constant, branchTarget
+	.if \registerConstant == 1
+		CPX #\constant
+	.endif
+	.if \registerConstant == 2
+		CPY #\constant
+	.endif
+	BCC \branchTarget
+.endmacro
+
+// @GENERATE @COMPOSITE
+// pushRegister + pushGlobal + branchIfLessThanFromStack
+branchIfRegisterLessThanGlobal .macro registerConstant, global, globalSize, branchTarget
+	.errorif \globalSize != 1, "Only 1-byte globals can be compared against a register"
+	.if \registerConstant == 1
+		CPX \global
+	.endif
+	.if \registerConstant == 2
+		CPY \global
+	.endif
+	BCC \branchTarget
+.endmacro
+
+// @GENERATE @COMPOSITE @PUSH=type;size
+// pushRegister + pushAddressOfRomDataElementFromStack + pushDereferenceFromStack
+// The index is already in a register, so the element is read with absolute indexing instead of building a pointer.
+pushRomDataElementFromRegister .macro romDataGlobal, referentTypeSize, registerConstant, type, size
+	.errorif \referentTypeSize != 1, "Only referentTypeSize of 1 is currently supported for pushRomDataElementFromRegister"
+	.if \registerConstant == 1
+		LDA \romDataGlobal,X
+	.endif
+	.if \registerConstant == 2
+		LDA \romDataGlobal,Y
+	.endif
+	PHA
+.endmacro
+
 // @GENERATE @POP=1 @OPTIONALINSTPARAM
 // Pops {globalSize} bytes off the stack and stores them at {targetAddress}.
 // Effects: STACK-1, AccChange, MemChange
@@ -263,11 +418,20 @@ popToGlobal .macro global, globalType, globalSize, stackType, stackSize
 		LDA #0
 		STA \global+1
 	.else
-		.errorif \globalSize != \stackSize, "Global/stack size mismatch for popToGlobal"
-		.for i = \global, i < \global + \globalSize, i = i + 1
+		// 8/16-bit integers are truncated or zero-extended to the size of the global, the same as storing
+		// CIL's int32 into a short integer would.
+		.errorif (\globalSize != \stackSize) && (\globalSize > 2 || \stackSize > 2), "Global/stack size mismatch for popToGlobal"
+		.for i = 0, i < \stackSize, i = i + 1
 			PLA
-			STA i
+			.if i < \globalSize
+				.let destination = \global + i
+				STA destination
+			.endif
 		.next
+		.if \globalSize > \stackSize
+			LDA #0
+			STA \global + 1
+		.endif
 	.endif
 .endmacro
 
@@ -275,11 +439,16 @@ popToGlobal .macro global, globalType, globalSize, stackType, stackSize
 // Can replace a consecutive ".push(...) .popTo(...)" as an optimization.
 // Copies directly between 2 addresses without using PHA/PLA
 copyGlobalToGlobal .macro fromGlobal, fromSize, toGlobal, toSize
-	.errorif \fromSize != \toSize, "Sizes currently need to match for copyGlobalToGlobal."
-	.for i = 0, i < \fromSize, i = i + 1
-		.let source = \fromGlobal + i
+	// Like popToGlobal, copying between 8/16-bit integers truncates or zero-extends.
+	.errorif (\fromSize != \toSize) && (\fromSize > 2 || \toSize > 2), "Sizes currently need to match for copyGlobalToGlobal."
+	.for i = 0, i < \toSize, i = i + 1
 		.let destination = \toGlobal + i
-		LDA source
+		.if i < \fromSize
+			.let source = \fromGlobal + i
+			LDA source
+		.else
+			LDA #0
+		.endif
 		STA destination
 	.next
 .endmacro
@@ -290,6 +459,13 @@ getAddResultType .function firstOperandTypeExpression, secondOperandTypeExpressi
 		.return TYPE_System_Byte
 	.elseif isPointer(firstOperandTypeExpression) == true && secondOperandTypeExpression == TYPE_System_Byte
 		.return firstOperandTypeExpression
+	// A byte operand is widened to the 16-bit operand's type. Mixing signed and unsigned 16-bit operands takes the first's.
+	.elseif isWideInteger(firstOperandTypeExpression) == true && (isWideInteger(secondOperandTypeExpression) == true || secondOperandTypeExpression == TYPE_System_Byte)
+		.return firstOperandTypeExpression
+	.elseif firstOperandTypeExpression == TYPE_System_Byte && isWideInteger(secondOperandTypeExpression) == true
+		.return secondOperandTypeExpression
+	.elseif firstOperandTypeExpression == TYPE_VCSFramework_Fixed8_8 && secondOperandTypeExpression == TYPE_VCSFramework_Fixed8_8
+		.return TYPE_VCSFramework_Fixed8_8
 	.else
 		.error "Unsupported add types"
 	.endif
@@ -299,6 +475,8 @@ getAddResultType .function firstOperandTypeExpression, secondOperandTypeExpressi
 getBitOpResultType .function firstOperandTypeExpression, secondOperandTypeExpression
 	.if firstOperandTypeExpression == TYPE_System_Boolean && secondOperandTypeExpression == TYPE_System_Boolean
 		.return TYPE_System_Boolean
+	.elseif firstOperandTypeExpression == TYPE_System_Byte && secondOperandTypeExpression == TYPE_System_Byte
+		.return TYPE_System_Byte
 	.else
 		.error "Unsupported bit op types"
 	.endif
@@ -337,6 +515,26 @@ isShortInteger .function type
 	.return type == TYPE_System_Byte || type == TYPE_System_Boolean
 .endfunction
 
+isWideInteger .function type
+	.return type == TYPE_System_UInt16 || type == TYPE_System_Int16
+.endfunction
+
+// Signed comparisons only matter for 16-bit values, bytes are always unsigned.
+isSigned .function type
+	.return type == TYPE_System_Int16
+.endfunction
+
+// Comparisons flip sign bits to order signed values as unsigned ones, if either operand is signed.
+isSignedComparison .function firstType, secondType
+	.return isSigned(firstType) || isSigned(secondType)
+.endfunction
+
+// An unsigned 16-bit operand in a signed comparison (e.g. a short compared with a constant from 256 up) only fits in a
+// signed value if it's below $8000, so it needs a check first. A zero-extended byte always fits.
+isUnsignedWideInSignedComparison .function type, size, otherType
+	.return isSigned(type) == false && size == 2 && isSigned(otherType)
+.endfunction
+
 // @GENERATE
 // Could be either a label or a stack type array access. No discriminated unions, so just drop it to IExpression.
 getSizeFromBuiltInType .function typeExpression, sizeExpression
@@ -345,6 +543,12 @@ getSizeFromBuiltInType .function typeExpression, sizeExpression
 		.return SIZE_System_Byte
 	.elseif typeExpression == TYPE_System_Boolean
 		.return SIZE_System_Boolean
+	.elseif typeExpression == TYPE_System_UInt16
+		.return SIZE_System_UInt16
+	.elseif typeExpression == TYPE_System_Int16
+		.return SIZE_System_Int16
+	.elseif typeExpression == TYPE_VCSFramework_Fixed8_8
+		.return SIZE_VCSFramework_Fixed8_8
 	.elseif isPointer(typeExpression) == true
 		.return sizeExpression
 	.else
@@ -361,7 +565,7 @@ max .function aExpression, bExpression
 	.endif
 .endfunction
 
-// @GENERATE @SIZEFIRST @RESERVED=1 @PUSH=getAddResultType(firstOperandStackType,secondOperandStackType);getSizeFromBuiltInType(getAddResultType(firstOperandStackType,secondOperandStackType),max(size[0],size[1])) @POP=2
+// @GENERATE @SIZEFIRST @RESERVED=2 @PUSH=getAddResultType(firstOperandStackType,secondOperandStackType);getSizeFromBuiltInType(getAddResultType(firstOperandStackType,secondOperandStackType),max(size[0],size[1])) @POP=2
 // Primitive
 addFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandStackType, secondOperandStackSize
 	// @TODO Need to know if this is signed/unsigned addition (pass in arrays?)
@@ -393,47 +597,161 @@ addFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandS
 		LDA INTERNAL_RESERVED_0
 		PHA
 	.else
-		.error "Invalid addFromStack param sizes"
+		// 16-bit addition, a byte operand is zero-extended.
+		.errorif \firstOperandStackSize > 2 || \secondOperandStackSize > 2, "Invalid addFromStack param sizes"
+		.errorif isPointer(\firstOperandStackType) == true, "Pointers can only have a byte added to them"
+		PLA
+		STA INTERNAL_RESERVED_0
+		.if \secondOperandStackSize == 2
+			PLA
+		.else
+			LDA #0
+		.endif
+		STA INTERNAL_RESERVED_1
+		PLA
+		CLC
+		ADC INTERNAL_RESERVED_0
+		STA INTERNAL_RESERVED_0
+		.if \firstOperandStackSize == 2
+			PLA
+		.else
+			LDA #0
+		.endif
+		ADC INTERNAL_RESERVED_1
+		PHA
+		LDA INTERNAL_RESERVED_0
+		PHA
 	.endif
 .endmacro
 
-// @GENERATE @COMPOSITE @PUSH=getAddResultType(globalType,constantType);getSizeFromBuiltInType(type[0],size[0])
+// @GENERATE @COMPOSITE @RESERVED=1 @PUSH=getAddResultType(globalType,constantType);getSizeFromBuiltInType(getAddResultType(globalType,constantType),max(globalSize,constantSize))
 // .pushGlobal + .pushConstant + .addFromStack
 // OR
 // .pushConstant + .pushGlobal + .addFromStack
 addFromGlobalAndConstant .macro global, globalType, globalSize, constant, constantType, constantSize
-	.errorif \globalSize != \constantSize, "Differing operand sizes not yet supported for addFromGlobalAndConstant."
-	.errorif \globalSize != 1, ">1-byte addition not supported yet for addFromGlobalAndConstant"
+	.errorif \globalSize > 2 || \constantSize > 2, ">2-byte addition not supported for addFromGlobalAndConstant"
 	.if \globalSize == 1 && \constantSize == 1
 		LDA \global
 		CLC
-		ADC \constant
+		ADC #\constant
 		PHA
 	.else
+		.let lowConstant = \constant & $FF
+		.let highConstant = (\constant >> 8) & $FF
+		LDA \global
+		CLC
+		ADC #lowConstant
+		STA INTERNAL_RESERVED_0
+		.if \globalSize == 2
+			LDA \global + 1
+		.else
+			LDA #0
+		.endif
+		ADC #highConstant
+		PHA
+		LDA INTERNAL_RESERVED_0
+		PHA
 	.endif
 .endmacro
 
 // @GENERATE @COMPOSITE
 // .addFromGlobalAndConstant + .popToGlobal
+// 16-bit additions are an ADC carry chain straight through zero-page, and never touch the stack.
 addFromGlobalAndConstantToGlobal .macro sourceGlobal, sourceGlobalType, sourceGlobalSize, constant, constantType, constantSize, targetGlobal, targetType, targetSize
-	.errorif \sourceGlobalSize != \constantSize, "Differing operand sizes not yet supported for addFromGlobalAndConstantToGlobal."
-	.errorif \sourceGlobalSize != 1, ">1-byte increment not supported yet for addFromGlobalAndConstantToGlobal"
-	.errorif \targetSize != 1, ">1-byte increment not supported yet for addFromGlobalAndConstantToGlobal"
-	.if \sourceGlobalSize == 1 && \constantSize == 1
+	.errorif \sourceGlobalSize > 2 || \constantSize > 2 || \targetSize > 2, ">2-byte addition not supported for addFromGlobalAndConstantToGlobal"
+	.let lowConstant = \constant & $FF
+	.let highConstant = (\constant >> 8) & $FF
+	.if \targetSize == 1
 		LDA \sourceGlobal
 		CLC
-		ADC \constant
+		ADC #lowConstant
 		STA \targetGlobal
 		// ^^ 10 cycles
-	.else
+	.endif
+	.if \targetSize == 2 && \sourceGlobal == \targetGlobal && \sourceGlobalSize == 2 && highConstant == 0
+		// Adding a byte in place only has to touch the high byte when the low byte carries.
+		LDA \targetGlobal
+		CLC
+		ADC #lowConstant
+		STA \targetGlobal
+		BCC +
+		INC \targetGlobal + 1
++
+		// ^^ 13 cycles, 17 on a carry
+	.endif
+	.if \targetSize == 2 && !(\sourceGlobal == \targetGlobal && \sourceGlobalSize == 2 && highConstant == 0)
+		LDA \sourceGlobal
+		CLC
+		ADC #lowConstant
+		STA \targetGlobal
+		.if \sourceGlobalSize == 2
+			LDA \sourceGlobal + 1
+		.else
+			LDA #0
+		.endif
+		ADC #highConstant
+		STA \targetGlobal + 1
+		// ^^ 18 cycles
 	.endif
 .endmacro
 
 // @GENERATE @COMPOSITE
 // .addFromGlobalAndConstantToGlobal iff sourceGlobal==targetGlobal AND constant==(1 OR 2)
 incrementGlobal .macro global, globalType, globalSize
-	.errorif \globalSize != 1, ">1-byte increment not supported yet for incrementGlobal"
+	.errorif \globalSize > 2, ">2-byte increment not supported for incrementGlobal"
 	INC \global // 5 cycles
+	.if \globalSize == 2
+		// The high byte only changes when the low byte wraps around to 0.
+		BNE +
+		INC \global + 1
++
+		// ^^ 8 cycles, 12 on a wrap
+	.endif
+.endmacro
+
+// @GENERATE @COMPOSITE
+// .subFromGlobalAndConstantToGlobal iff sourceGlobal==targetGlobal AND constant==1
+decrementGlobal .macro global, globalType, globalSize
+	.errorif \globalSize > 2, ">2-byte decrement not supported for decrementGlobal"
+	.if \globalSize == 2
+		// The high byte only changes when the low byte wraps around from 0.
+		LDA \global
+		BNE +
+		DEC \global + 1
++
+		// ^^ 6 cycles, 10 on a wrap
+	.endif
+	DEC \global // 5 cycles
+.endmacro
+
+// @GENERATE @COMPOSITE
+// .pushGlobal + .pushGlobal + .addFromStack + .popToGlobal
+// Adds 2 globals (e.g. a velocity to a position) straight through zero-page, without the stack.
+addFromGlobalAndGlobalToGlobal .macro firstGlobal, firstGlobalSize, secondGlobal, secondGlobalSize, targetGlobal, targetSize
+	.errorif \firstGlobalSize > 2 || \secondGlobalSize > 2 || \targetSize > 2, ">2-byte addition not supported for addFromGlobalAndGlobalToGlobal"
+	LDA \firstGlobal
+	CLC
+	ADC \secondGlobal
+	STA \targetGlobal
+	.if \targetSize == 2 && \firstGlobalSize == 1 && \secondGlobalSize == 1
+		// byte+byte is a byte, same as addFromStack.
+		LDA #0
+		STA \targetGlobal + 1
+	.endif
+	.if \targetSize == 2 && (\firstGlobalSize == 2 || \secondGlobalSize == 2)
+		.if \firstGlobalSize == 2
+			LDA \firstGlobal + 1
+		.else
+			LDA #0
+		.endif
+		.if \secondGlobalSize == 2
+			ADC \secondGlobal + 1
+		.else
+			ADC #0
+		.endif
+		STA \targetGlobal + 1
+		// ^^ 20 cycles for 16+16 bits
+	.endif
 .endmacro
 
 addFromAddresses .macro addressA, sizeA, addressB, sizeB
@@ -459,7 +777,7 @@ addFromAddressesToAddress .macro addressA, sizeA, addressB, sizeB, targetAddress
 	.endif
 .endmacro
 
-// @GENERATE @RESERVED=1 @POP=2 @PUSH=getAddResultType(firstOperandStackType,secondOperandStackType);getSizeFromBuiltInType(type[0],size[0])
+// @GENERATE @RESERVED=2 @POP=2 @PUSH=getAddResultType(firstOperandStackType,secondOperandStackType);getSizeFromBuiltInType(type[0],max(size[0],size[1]))
 // Primitive
 subFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandStackType, secondOperandStackSize
 	.invoke getAddResultType(\firstOperandStackType, \secondOperandStackType) // @TODO - Does this apply to add+sub?
@@ -471,7 +789,95 @@ subFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandS
 		SBC INTERNAL_RESERVED_0
 		PHA
 	.else
-		.error "Invalid subFromStack param sizes"
+		// 16-bit subtraction, a byte operand is zero-extended.
+		.errorif \firstOperandStackSize > 2 || \secondOperandStackSize > 2, "Invalid subFromStack param sizes"
+		PLA
+		STA INTERNAL_RESERVED_0
+		.if \secondOperandStackSize == 2
+			PLA
+		.else
+			LDA #0
+		.endif
+		STA INTERNAL_RESERVED_1
+		PLA
+		SEC
+		SBC INTERNAL_RESERVED_0
+		STA INTERNAL_RESERVED_0
+		.if \firstOperandStackSize == 2
+			PLA
+		.else
+			LDA #0
+		.endif
+		SBC INTERNAL_RESERVED_1
+		PHA
+		LDA INTERNAL_RESERVED_0
+		PHA
+	.endif
+.endmacro
+
+// @GENERATE @COMPOSITE
+// .pushGlobal + .pushConstant + .subFromStack + .popToGlobal
+// 16-bit subtractions are an SBC borrow chain straight through zero-page, and never touch the stack.
+subFromGlobalAndConstantToGlobal .macro sourceGlobal, sourceGlobalType, sourceGlobalSize, constant, constantType, constantSize, targetGlobal, targetType, targetSize
+	.errorif \sourceGlobalSize > 2 || \constantSize > 2 || \targetSize > 2, ">2-byte subtraction not supported for subFromGlobalAndConstantToGlobal"
+	.let lowConstant = \constant & $FF
+	.let highConstant = (\constant >> 8) & $FF
+	.if \targetSize == 1
+		LDA \sourceGlobal
+		SEC
+		SBC #lowConstant
+		STA \targetGlobal
+	.endif
+	.if \targetSize == 2 && \sourceGlobal == \targetGlobal && \sourceGlobalSize == 2 && highConstant == 0
+		// Subtracting a byte in place only has to touch the high byte when the low byte borrows.
+		LDA \targetGlobal
+		SEC
+		SBC #lowConstant
+		STA \targetGlobal
+		BCS +
+		DEC \targetGlobal + 1
++
+	.endif
+	.if \targetSize == 2 && !(\sourceGlobal == \targetGlobal && \sourceGlobalSize == 2 && highConstant == 0)
+		LDA \sourceGlobal
+		SEC
+		SBC #lowConstant
+		STA \targetGlobal
+		.if \sourceGlobalSize == 2
+			LDA \sourceGlobal + 1
+		.else
+			LDA #0
+		.endif
+		SBC #highConstant
+		STA \targetGlobal + 1
+	.endif
+.endmacro
+
+// @GENERATE @COMPOSITE
+// .pushGlobal + .pushGlobal + .subFromStack + .popToGlobal
+subFromGlobalAndGlobalToGlobal .macro firstGlobal, firstGlobalSize, secondGlobal, secondGlobalSize, targetGlobal, targetSize
+	.errorif \firstGlobalSize > 2 || \secondGlobalSize > 2 || \targetSize > 2, ">2-byte subtraction not supported for subFromGlobalAndGlobalToGlobal"
+	LDA \firstGlobal
+	SEC
+	SBC \secondGlobal
+	STA \targetGlobal
+	.if \targetSize == 2 && \firstGlobalSize == 1 && \secondGlobalSize == 1
+		// byte-byte is a byte, same as subFromStack.
+		LDA #0
+		STA \targetGlobal + 1
+	.endif
+	.if \targetSize == 2 && (\firstGlobalSize == 2 || \secondGlobalSize == 2)
+		.if \firstGlobalSize == 2
+			LDA \firstGlobal + 1
+		.else
+			LDA #0
+		.endif
+		.if \secondGlobalSize == 2
+			SBC \secondGlobal + 1
+		.else
+			SBC #0
+		.endif
+		STA \targetGlobal + 1
 	.endif
 .endmacro
 
@@ -512,6 +918,314 @@ subLocalByConstant .macro local, constant // @TODO SIZES
 	.endif
 .endmacro
 
+// Multiplication, division and shifts.
+// The 6502 has no multiply/divide instructions, so all of these are built out of shifts, adds and subtracts.
+// Only the low byte of a product is kept, since CIL truncates the result back down to a byte (conv.u1) anyway.
+// Operations with a constant operand are lowered to straight-line shift/add code by the optimizer. Operations with
+// two variable operands pick between a smaller and faster implementation based on CompilerOptions.MathStrategy.
+
+// @GENERATE @RESERVED=2 @POP=2 @PUSH=type[byte];size[byte]
+// Primitive
+// useTableConstant=0: Shift-and-add loop. ~13 bytes, ~130 cycles.
+// useTableConstant=1: Quarter-square lookup, a*b = sqr(a+b) - sqr(|a-b|). ~30 bytes + 512 bytes of tables, ~35 cycles.
+multiplyFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandStackType, secondOperandStackSize, useTableConstant
+	.errorIf \firstOperandStackSize != 1 || \secondOperandStackSize != 1, "Currently operands must be 1 byte in size for multiplyFromStack"
+	PLA
+	STA INTERNAL_RESERVED_0
+	PLA
+	STA INTERNAL_RESERVED_1
+	.if \useTableConstant == 0
+		LDA #0
+		LDX #8
+-	ASL A
+		ASL INTERNAL_RESERVED_0
+		BCC +
+		CLC
+		ADC INTERNAL_RESERVED_1
++	DEX
+		BNE -
+	.else
+		// Y = |a-b|
+		SEC
+		SBC INTERNAL_RESERVED_0
+		BCS _positive
+		EOR #$FF
+		ADC #1 // Carry is clear here, so this negates.
+_positive
+		TAY
+		// X = (a+b) & $FF, Carry = (a+b) >> 8
+		LDA INTERNAL_RESERVED_1
+		CLC
+		ADC INTERNAL_RESERVED_0
+		TAX
+		BCS _high
+		LDA MATH_QUARTER_SQUARES_0,X
+		BCC _subtract // LDA doesn't touch carry, so this always branches.
+_high
+		LDA MATH_QUARTER_SQUARES_1,X
+_subtract
+		SEC
+		SBC MATH_QUARTER_SQUARES_0,Y
+	.endif
+	PHA
+.endmacro
+
+// @GENERATE @COMPOSITE @RESERVED=1 @POP=1 @PUSH=type[byte];size[byte]
+// .pushConstant + .multiplyFromStack
+// Multiplies by a constant using Horner's method over the constant's bits, e.g. x*10 = ((x*2)*2+x)*2.
+multiplyFromStackByConstant .macro constant, stackType, stackSize
+	.errorIf \stackSize != 1, "Currently operand must be 1 byte in size for multiplyFromStackByConstant"
+	.let multiplier = \constant & $FF
+	.if multiplier == 0
+		PLA
+		LDA #0
+		PHA
+	.else
+		.let highestBit = 0
+		.for i = 0, i < 8, i = i + 1
+			.if ((multiplier >> i) & 1) == 1
+				.let highestBit = i
+			.endif
+		.next
+		.if multiplier != (1 << highestBit)
+			// Not a power of 2, so we need the original value for the adds.
+			PLA
+			STA INTERNAL_RESERVED_0
+		.else
+			PLA
+		.endif
+		.for i = highestBit - 1, i >= 0, i = i - 1
+			ASL A
+			.if ((multiplier >> i) & 1) == 1
+				CLC
+				ADC INTERNAL_RESERVED_0
+			.endif
+		.next
+		PHA
+	.endif
+.endmacro
+
+// Divides INTERNAL_RESERVED_1 by INTERNAL_RESERVED_0 (restoring division).
+// Afterwards INTERNAL_RESERVED_1 holds the quotient and A holds the remainder. Division by 0 produces a quotient of $FF.
+divideInternal .macro unrollConstant
+	LDA #0
+	.if \unrollConstant == 0
+		LDX #8
+-	ASL INTERNAL_RESERVED_1
+		ROL A
+		CMP INTERNAL_RESERVED_0
+		BCC +
+		SBC INTERNAL_RESERVED_0
+		INC INTERNAL_RESERVED_1
++	DEX
+		BNE -
+	.else
+		// Anonymous labels repeated by .for never settle across passes, so each step gets its own block.
+		.for i = 0, i < 8, i = i + 1
+			.block
+			ASL INTERNAL_RESERVED_1
+			ROL A
+			CMP INTERNAL_RESERVED_0
+			BCC +
+			SBC INTERNAL_RESERVED_0
+			INC INTERNAL_RESERVED_1
++
+			.endblock
+		.next
+	.endif
+.endmacro
+
+// @GENERATE @RESERVED=2 @POP=2 @PUSH=type[byte];size[byte]
+// Primitive
+// unrollConstant=0: Loop, ~20 bytes, ~200 cycles. unrollConstant=1: Unrolled, ~100 bytes, ~160 cycles.
+// A 16-bit divisor (e.g. a constant above 255) with a nonzero high byte is larger than any byte, so the quotient is 0.
+divideFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandStackType, secondOperandStackSize, unrollConstant
+	.errorIf \firstOperandStackSize != 1 || \secondOperandStackSize > 2, "Currently the dividend must be 1 byte and the divisor 1 or 2 bytes in size for divideFromStack"
+	PLA
+	STA INTERNAL_RESERVED_0
+	.if \secondOperandStackSize == 2
+		PLA
+		BNE _divisorAboveByte
+	.endif
+	PLA
+	STA INTERNAL_RESERVED_1
+	.divideInternal \unrollConstant
+	LDA INTERNAL_RESERVED_1
+	.if \secondOperandStackSize == 2
+		JMP _end
+	.endif
+_divisorAboveByte
+	.if \secondOperandStackSize == 2
+		PLA
+		LDA #0
+	.endif
+_end
+	PHA
+.endmacro
+
+// @GENERATE @RESERVED=2 @POP=2 @PUSH=type[byte];size[byte]
+// Primitive
+// A 16-bit divisor with a nonzero high byte is larger than any byte, so the dividend is left on the stack as the remainder.
+remainderFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandStackType, secondOperandStackSize, unrollConstant
+	.errorIf \firstOperandStackSize != 1 || \secondOperandStackSize > 2, "Currently the dividend must be 1 byte and the divisor 1 or 2 bytes in size for remainderFromStack"
+	PLA
+	STA INTERNAL_RESERVED_0
+	.if \secondOperandStackSize == 2
+		PLA
+		BNE _end
+	.endif
+	PLA
+	STA INTERNAL_RESERVED_1
+	.divideInternal \unrollConstant
+	PHA
+_end
+.endmacro
+
+// @GENERATE @COMPOSITE @RESERVED=2 @POP=1 @PUSH=type[byte];size[byte]
+// .pushConstant + .divideFromStack
+// Powers of 2 become right shifts, anything else falls back to a division with the divisor loaded as a constant.
+// A constant above 255 (pushed as a ushort) is larger than any byte, so the quotient is 0.
+divideFromStackByConstant .macro constant, stackType, stackSize, unrollConstant
+	.errorIf \stackSize != 1, "Currently operand must be 1 byte in size for divideFromStackByConstant"
+	.errorIf \constant == 0, "Division by constant 0"
+	.if \constant > $FF
+		PLA
+		LDA #0
+		PHA
+	.elseif (\constant & (\constant - 1)) == 0
+		PLA
+		.for i = 1, i < \constant, i = i * 2
+			LSR A
+		.next
+		PHA
+	.else
+		PLA
+		STA INTERNAL_RESERVED_1
+		LDA #\constant
+		STA INTERNAL_RESERVED_0
+		.divideInternal \unrollConstant
+		LDA INTERNAL_RESERVED_1
+		PHA
+	.endif
+.endmacro
+
+// @GENERATE @COMPOSITE @RESERVED=2 @POP=1 @PUSH=type[byte];size[byte]
+// .pushConstant + .remainderFromStack
+// Powers of 2 become a mask, anything else falls back to a division with the divisor loaded as a constant.
+// A constant above 255 (pushed as a ushort) is larger than any byte, so the remainder is the operand itself.
+remainderFromStackByConstant .macro constant, stackType, stackSize, unrollConstant
+	.errorIf \stackSize != 1, "Currently operand must be 1 byte in size for remainderFromStackByConstant"
+	.errorIf \constant == 0, "Remainder by constant 0"
+	.if \constant > $FF
+		// Nothing to do, the operand stays on the stack.
+	.elseif (\constant & (\constant - 1)) == 0
+		PLA
+		AND #(\constant - 1)
+		PHA
+	.else
+		PLA
+		STA INTERNAL_RESERVED_1
+		LDA #\constant
+		STA INTERNAL_RESERVED_0
+		.divideInternal \unrollConstant
+		PHA
+	.endif
+.endmacro
+
+// @GENERATE @POP=2 @PUSH=type[byte];size[byte]
+// Primitive
+// Value is pushed first, then the shift count.
+shiftLeftFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandStackType, secondOperandStackSize
+	.errorIf \firstOperandStackSize != 1 || \secondOperandStackSize != 1, "Currently operands must be 1 byte in size for shiftLeftFromStack"
+	PLA
+	TAX
+	PLA
+	CPX #0
+	BEQ +
+-	ASL A
+	DEX
+	BNE -
++	PHA
+.endmacro
+
+// @GENERATE @RESERVED=1 @POP=2 @PUSH=type[byte];size[byte]
+// Primitive
+// Always a logical shift. Byte operands are zero-extended by CIL, so shr and shr.un behave the same.
+// A 16-bit operand is shifted as a whole and its low byte is the result, like shiftRightFromStackByConstant.
+shiftRightFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandStackType, secondOperandStackSize
+	.errorIf \firstOperandStackSize > 2 || \secondOperandStackSize != 1, "Currently the shift amount must be 1 byte and the operand 1 or 2 bytes in size for shiftRightFromStack"
+	PLA
+	TAX
+	PLA
+	.if \firstOperandStackSize == 2
+		STA INTERNAL_RESERVED_0
+		PLA
+		CPX #0
+		BEQ +
+-		LSR A
+		ROR INTERNAL_RESERVED_0
+		DEX
+		BNE -
++		LDA INTERNAL_RESERVED_0
+		PHA
+	.else
+		CPX #0
+		BEQ +
+-		LSR A
+		DEX
+		BNE -
++		PHA
+	.endif
+.endmacro
+
+// @GENERATE @COMPOSITE @POP=1 @PUSH=type[byte];size[byte]
+// .pushConstant + .shiftLeftFromStack
+shiftLeftFromStackByConstant .macro constant, stackType, stackSize
+	.errorIf \stackSize != 1, "Currently operand must be 1 byte in size for shiftLeftFromStackByConstant"
+	PLA
+	.if \constant >= 8
+		LDA #0
+	.else
+		.for i = 0, i < \constant, i = i + 1
+			ASL A
+		.next
+	.endif
+	PHA
+.endmacro
+
+// @GENERATE @COMPOSITE @POP=1 @PUSH=type[byte];size[byte]
+// .pushConstant + .shiftRightFromStack
+shiftRightFromStackByConstant .macro constant, stackType, stackSize
+	.errorIf \stackSize > 2, "Currently operand must be 1 or 2 bytes in size for shiftRightFromStackByConstant"
+	.if \stackSize == 2
+		// e.g. taking the integer part of a Fixed8_8's raw value.
+		.errorIf \constant < 8, "16-bit operands can only be shifted right by 8 or more for shiftRightFromStackByConstant"
+		// The low byte is shifted out entirely, leaving the high byte as the result.
+		PLA
+		.if \constant > 8
+			PLA
+			.if \constant >= 16
+				LDA #0
+			.else
+				.for i = 8, i < \constant, i = i + 1
+					LSR A
+				.next
+			.endif
+			PHA
+		.endif
+	.else
+		PLA
+		.if \constant >= 8
+			LDA #0
+		.else
+			.for i = 0, i < \constant, i = i + 1
+				LSR A
+			.next
+		.endif
+		PHA
+	.endif
+.endmacro
+
 // @GENERATE
 // Primitive, also optimizable.
 // addFromAddressesToAddress + copyTo = addFromAddressesToAddress + storeTo iff ToAddress target == copyTo source.
@@ -533,14 +1247,40 @@ convertToByte .macro
 
 // @GENERATE @RESERVED=1 @POP=1 @PUSH=stackType;stackSize
 negateFromStack .macro stackType, stackSize
-	.errorIf \stackSize != 1, "Currently operand must be 1 byte in size for negateFromStack"
+	.errorIf \stackSize > 2, "Currently operand must be 1 or 2 bytes in size for negateFromStack"
+	.if \stackSize == 1
+		PLA
+		STA INTERNAL_RESERVED_0
+		LDA #$FF
+		SEC
+		SBC INTERNAL_RESERVED_0
+		CLC
+		ADC #1
+		PHA
+	.else
+		// Invert both bytes and add 1, the carry out of the low byte ripples into the high byte.
+		PLA
+		EOR #$FF
+		CLC
+		ADC #1
+		STA INTERNAL_RESERVED_0
+		PLA
+		EOR #$FF
+		ADC #0
+		PHA
+		LDA INTERNAL_RESERVED_0
+		PHA
+	.endif
+.endmacro
+
+// @GENERATE @RESERVED=1 @POP=2 @PUSH=getBitOpResultType(firstOperandStackType,secondOperandStackType);getSizeFromBuiltInType(type[0],size[0])
+andFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandStackType, secondOperandStackSize
+	.errorIf \firstOperandStackType != \secondOperandStackType, "Currently types must be the same for andFromStack"
+	.errorIf \firstOperandStackSize != 1, "Currently operands must be 1 byte in size for andFromStack"
 	PLA
 	STA INTERNAL_RESERVED_0
-	LDA #$FF
-	SEC
-	SBC INTERNAL_RESERVED_0
-	CLC
-	ADC #1
+	PLA
+	AND INTERNAL_RESERVED_0
 	PHA
 .endmacro
 
@@ -555,14 +1295,76 @@ orFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandSt
 	PHA
 .endmacro
 
-// @GENERATE @RESERVED=1 @POP=2 @PUSH=type[bool];size[bool]
-compareEqualToFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandStackType, secondOperandStackSize
-	.errorIf \firstOperandStackType != \secondOperandStackType, "Currently types must be the same for compareEqualToFromStack"
-	.errorIf \firstOperandStackSize != 1, "Currently operands must be 1 byte in size for compareEqualToFromStack"
+// Not generated, shared by the comparison macros.
+// Pops 2 operands of up to 16 bits and subtracts the second from the first, a byte operand is zero-extended.
+// Afterwards Carry=1 if first >= second, and Zero=1 if first == second.
+// Signed comparisons (see isSignedComparison) flip both sign bits first, which maps -32768..32767 onto 0..65535 in order.
+// Like C#, a short compared with a ushort is compared as if both were ints: an unsigned operand of $8000 or more is
+// above any short, and anything below that compares the same way signed.
+compareWideFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandStackType, secondOperandStackSize
+	.errorIf \firstOperandStackSize > 2 || \secondOperandStackSize > 2, "Operands can be at most 2 bytes in size for comparisons"
+	.let firstIsUnsignedWide = isUnsignedWideInSignedComparison(\firstOperandStackType, \firstOperandStackSize, \secondOperandStackType)
+	.let secondIsUnsignedWide = isUnsignedWideInSignedComparison(\secondOperandStackType, \secondOperandStackSize, \firstOperandStackType)
 	PLA
 	STA INTERNAL_RESERVED_0
+	.if \secondOperandStackSize == 2
+		PLA
+	.else
+		LDA #0
+	.endif
+	.if isSignedComparison(\firstOperandStackType, \secondOperandStackType) == true
+		EOR #$80
+	.endif
+	STA INTERNAL_RESERVED_1
+	.if secondIsUnsignedWide == true
+		// A clear (flipped) sign bit means the second operand is $8000 or more.
+		BPL _unsignedAboveShort
+	.endif
 	PLA
-	CMP INTERNAL_RESERVED_0
+	SEC
+	SBC INTERNAL_RESERVED_0
+	STA INTERNAL_RESERVED_0
+	.if \firstOperandStackSize == 2
+		PLA
+	.else
+		LDA #0
+	.endif
+	.if isSignedComparison(\firstOperandStackType, \secondOperandStackType) == true
+		EOR #$80
+	.endif
+	.if firstIsUnsignedWide == true
+		BPL _unsignedAboveShort
+	.endif
+	SBC INTERNAL_RESERVED_1
+	// ORA leaves Carry alone, so Zero is only set if both bytes of the difference are 0.
+	ORA INTERNAL_RESERVED_0
+	.if firstIsUnsignedWide == true || secondIsUnsignedWide == true
+		JMP _compared
+	.endif
+_unsignedAboveShort
+	.if secondIsUnsignedWide == true
+		// The first operand (a short) is still on the stack, and is below the second.
+		PLA
+		PLA
+		LDA #$FF
+		CLC
+	.elseif firstIsUnsignedWide == true
+		LDA #$FF
+		SEC
+	.endif
+_compared
+.endmacro
+
+// @GENERATE @RESERVED=2 @POP=2 @PUSH=type[bool];size[bool]
+compareEqualToFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandStackType, secondOperandStackSize
+	.if \firstOperandStackSize == 1 && \secondOperandStackSize == 1
+		PLA
+		STA INTERNAL_RESERVED_0
+		PLA
+		CMP INTERNAL_RESERVED_0
+	.else
+		.compareWideFromStack \firstOperandStackType, \firstOperandStackSize, \secondOperandStackType, \secondOperandStackSize
+	.endif
 	BEQ _true
 	LDA #0
 	BEQ _end
@@ -574,12 +1376,17 @@ _end
 	PHA
 .endmacro
 
+// @GENERATE @RESERVED=2 @POP=2 @PUSH=type[bool];size[bool]
 // Primitive
-compareGreaterThanFromStack .macro // @TODO SIZE PARAMS
-	PLA
-	STA INTERNAL_RESERVED_0
-	PLA
-	CMP INTERNAL_RESERVED_0
+compareGreaterThanFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandStackType, secondOperandStackSize
+	.if \firstOperandStackSize == 1 && \secondOperandStackSize == 1
+		PLA
+		STA INTERNAL_RESERVED_0
+		PLA
+		CMP INTERNAL_RESERVED_0
+	.else
+		.compareWideFromStack \firstOperandStackType, \firstOperandStackSize, \secondOperandStackType, \secondOperandStackSize
+	.endif
 	// Carry=1 if A >= M, Zero=1 if A = M.
 	// Therefore need to check Zero first, then Carry.
 	BEQ _false
@@ -596,14 +1403,16 @@ _end
 	PHA
 .endmacro
 
-// @GENERATE @RESERVED=1
+// @GENERATE @RESERVED=2 @POP=2 @PUSH=type[bool];size[bool]
 compareLessThanFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandStackType, secondOperandStackSize
-	.errorIf \firstOperandStackType != \secondOperandStackType, "Currently types must be the same for compareLessThanFromStack"
-	.errorIf \firstOperandStackSize != 1, "Currently operands must be 1 byte in size for compareLessThanFromStack"
-	PLA
-	STA INTERNAL_RESERVED_0
-	PLA
-	CMP INTERNAL_RESERVED_0
+	.if \firstOperandStackSize == 1 && \secondOperandStackSize == 1
+		PLA
+		STA INTERNAL_RESERVED_0
+		PLA
+		CMP INTERNAL_RESERVED_0
+	.else
+		.compareWideFromStack \firstOperandStackType, \firstOperandStackSize, \secondOperandStackType, \secondOperandStackSize
+	.endif
 
 	BCC _true
 	LDA #0
@@ -689,18 +1498,58 @@ branchIfGreaterThanFromGlobalAndConstant .macro address, constant, branchTarget
 +
 .endmacro
 
-// @GENERATE @POP=2 @RESERVED=1
-branchIfLessThanFromStack .macro branchTarget
-	// @TODO - Parameter sizes
-	// Pop value2 into RESERVED. Pop value1 into A. Branch if value1 < value2.
-	PLA
-	STA INTERNAL_RESERVED_0
-	PLA
-	CMP INTERNAL_RESERVED_0
+// @GENERATE @POP=2 @RESERVED=2
+branchIfLessThanFromStack .macro firstOperandStackType, firstOperandStackSize, secondOperandStackType, secondOperandStackSize, branchTarget
+	.if \firstOperandStackSize == 1 && \secondOperandStackSize == 1
+		// Pop value2 into RESERVED. Pop value1 into A. Branch if value1 < value2.
+		PLA
+		STA INTERNAL_RESERVED_0
+		PLA
+		CMP INTERNAL_RESERVED_0
+	.else
+		.compareWideFromStack \firstOperandStackType, \firstOperandStackSize, \secondOperandStackType, \secondOperandStackSize
+	.endif
 
 	BCC \branchTarget
 .endmacro
 
+// @GENERATE @COMPOSITE
+// .pushGlobal + .pushConstant + .branchIfLessThanFromStack
+// 16-bit globals compare their high bytes first, and only look at the low bytes if those are equal.
+branchIfGlobalLessThanConstant .macro global, globalType, globalSize, constant, constantType, constantSize, branchTarget
+	.errorif \globalSize > 2 || \constantSize > 2, ">2-byte comparison not supported for branchIfGlobalLessThanConstant"
+	.if \globalSize == 1 && \constantSize == 1
+		LDA \global
+		CMP #\constant
+		BCC \branchTarget
+	.elseif isUnsignedWideInSignedComparison(\constantType, \constantSize, \globalType) == true && \constant >= $8000
+		// Every short is below an unsigned constant this large.
+		JMP \branchTarget
+	.elseif isSigned(\globalType) == false && isSigned(\constantType) == true && \constant >= $8000
+		// Nothing unsigned is below a negative constant.
+	.else
+		.let lowConstant = \constant & $FF
+		.let highConstant = (\constant >> 8) & $FF
+		.if \globalSize == 2
+			LDA \global + 1
+		.else
+			LDA #0
+		.endif
+		// Same sign bit flip as compareWideFromStack. The constant fits in a short by now, so only the global decides.
+		.if isSigned(\globalType) == true
+			EOR #$80
+			.let highConstant = highConstant ^ $80
+		.endif
+		CMP #highConstant
+		BCC \branchTarget
+		BNE +
+		LDA \global
+		CMP #lowConstant
+		BCC \branchTarget
++
+	.endif
+.endmacro
+
 // pushLocal + pushConstant + compareGreaterThanFromStack
 compareGreaterThanFromLocalAndConstant .macro local, constant //@TODO SIZE PARAMS
 	.compareGreaterThanFromGlobalAndConstant \local, \constant
@@ -761,11 +1610,11 @@ branchTrueFromLocal .macro local, branchTarget
 
 
 // @GENERATE @PUSH=type;size
-//@TODO Check if messed up endianness.
 //@TODO - Delete type?
 pushConstant .macro constant, type, size
 	.errorif \size > 2, "REPORTME: Bitshifting constants that are >16-bit produces unexpected results."
-	.for i = 0, i < \size, i = i + 1
+	// MSB first, so the LSB ends up on top like pushGlobal.
+	.for i = \size - 1, i >= 0, i = i - 1
 		.let itrByte = (\constant >> (i * 8)) & $FF
 		LDA #itrByte
 		PHA
@@ -787,10 +1636,35 @@ popToLocal .macro local, localType, localSize, stackType, stackSize
 // @GENERATE @COMPOSITE
 // pushConstant + popToGlobal
 assignConstantToGlobal .macro constant, global, size
-	//@TODO SIZE
-	.errorif \size > 1, "assignConstantToGlobal only supports 8-bit constants currently."
-	LDA #\constant
-	STA \global
+	.errorif \size > 2, "assignConstantToGlobal only supports 8/16-bit constants currently."
+	.if \size == 1
+		LDA #\constant
+		STA \global
+	.else
+		.let lowConstant = \constant & $FF
+		.let highConstant = (\constant >> 8) & $FF
+		LDA #lowConstant
+		STA \global
+		.if highConstant != lowConstant
+			LDA #highConstant
+		.endif
+		STA \global + 1
+	.endif
+.endmacro
+
+// @GENERATE @POP=1 @PUSH=type[byte];size[byte]
+// Truncates a Fixed8_8 to its integer part by dropping the fraction, which is on top of the stack.
+convertFixedPointToByteFromStack .macro stackType, stackSize
+	.errorif \stackType != TYPE_VCSFramework_Fixed8_8, "convertFixedPointToByteFromStack only converts Fixed8_8"
+	PLA
+.endmacro
+
+// @GENERATE @POP=1 @PUSH=type[fixed];size[fixed]
+// The byte already on the stack becomes the integer part, a zero fraction goes on top of it.
+convertByteToFixedPointFromStack .macro stackType, stackSize
+	.errorif \stackSize != 1, "convertByteToFixedPointFromStack only converts bytes"
+	LDA #0
+	PHA
 .endmacro
 
 // pushConstant + popToLocal
@@ -879,4 +1753,53 @@ clearMemory .macro
 entryPoint .macro
 	.initialize
 	.clearMemory
-.endmacro
\ No newline at end of file
+.endmacro
+
+// BEGIN SUPEROPTIMIZED MACROS
+// Composite macros found by VILSuperoptimizer. Everything between these markers is regenerated by the tool, do not edit by hand.
+
+// @GENERATE @COMPOSITE
+// .pushGlobal + .pushConstant + .subFromStack + .popToGlobal
+// Superoptimized: 10 cycles/7 bytes, was 37 cycles/17 bytes. Seen 3 times.
+fusedPushGlobalPushConstantSubFromStackPopToGlobalG0C0G0 .macro firstGlobal, firstConstant
+	LDA \firstGlobal
+	SEC
+	SBC #\firstConstant
+	STA \firstGlobal
+.endmacro
+
+// @GENERATE @COMPOSITE @PUSH=type[byte];size[byte]
+// .pushGlobal + .pushConstant + .subFromStack
+// Superoptimized: 10 cycles/6 bytes, was 30 cycles/14 bytes. Seen 3 times.
+fusedPushGlobalPushConstantSubFromStackG0C0 .macro firstGlobal, firstConstant
+	LDA \firstGlobal
+	SEC
+	SBC #\firstConstant
+	PHA
+.endmacro
+
+// @GENERATE @COMPOSITE @PUSH=type[byte];size[byte]
+// .pushGlobal + .pushConstant + .andFromStack
+// Superoptimized: 8 cycles/5 bytes, was 28 cycles/13 bytes. Seen 2 times.
+fusedPushGlobalPushConstantAndFromStackG0C0 .macro firstGlobal, firstConstant
+	LDA #\firstConstant
+	AND \firstGlobal
+	PHA
+.endmacro
+
+// @GENERATE @COMPOSITE
+// .pushGlobal + .branchTrueFromStack
+// Superoptimized: 8 cycles/7 bytes, was 15 cycles/9 bytes. Seen 4 times.
+fusedPushGlobalBranchTrueFromStackG0 .macro firstGlobal, branchTarget
+	LDA \firstGlobal
+	JNE \branchTarget
+.endmacro
+
+// @GENERATE @COMPOSITE
+// .pushGlobal + .branchFalseFromStack
+// Superoptimized: 8 cycles/7 bytes, was 15 cycles/9 bytes. Seen 2 times.
+fusedPushGlobalBranchFalseFromStackG0 .macro firstGlobal, branchTarget
+	LDA \firstGlobal
+	JEQ \branchTarget
+.endmacro
+// END SUPEROPTIMIZED MACROS
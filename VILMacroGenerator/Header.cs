@@ -1,5 +1,4 @@
 ﻿#nullable enable
-using Microsoft.CodeAnalysis;
 using System;
 using System.Collections.Generic;
 using System.Linq;
@@ -67,16 +66,16 @@ namespace VILMacroGenerator
         public string? DeprecatedString { get; private set; }
         public bool TypeFirst { get; private set; } = true;
 
-        public static Header? Parse(string generateLine, GeneratorExecutionContext context)
+        public static Header? Parse(string generateLine, out VilDiagnostic? diagnostic)
         {
+            diagnostic = null;
             var header = new Header();
             var parts = generateLine.Split(' ');
 
             var pushStr = parts.SingleOrDefault(p => p.StartsWith("@PUSH=", StringComparison.CurrentCultureIgnoreCase));
             if (pushStr != null && char.IsDigit(pushStr.Last()))
             {
-                var desc = new DiagnosticDescriptor(MacroGenerator.OldPushFormatId, "Old @PUSH format", "Specifying a number for @PUSH isn't supported anymore, line: {0}", MacroGenerator.VilCategory, DiagnosticSeverity.Error, true);
-                context.ReportDiagnostic(Diagnostic.Create(desc, null, generateLine));
+                diagnostic = new VilDiagnostic(MacroGenerator.OldPushFormatId, "Old @PUSH format", $"Specifying a number for @PUSH isn't supported anymore, line: {generateLine}");
                 return null;
             }
             if (pushStr != null)
@@ -173,6 +172,11 @@ namespace VILMacroGenerator
                     label = $"new {(isType ? "TypeLabel" : "TypeSizeLabel")}(BuiltInDefinitions.Bool)";
                     return true;
                 }
+                else if (value.Equals("fixed", StringComparison.CurrentCultureIgnoreCase))
+                {
+                    label = $"new {(isType ? "TypeLabel" : "TypeSizeLabel")}(BuiltInDefinitions.Fixed8_8)";
+                    return true;
+                }
                 else if (value.Equals(longPointerName, StringComparison.CurrentCultureIgnoreCase))
                 {
                     if (isType)
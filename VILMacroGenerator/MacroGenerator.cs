@@ -6,99 +6,128 @@ using System.Collections;
 using System.Collections.Generic;
 using System.Collections.Immutable;
 using System.Diagnostics;
+using System.IO;
 using System.Linq;
 using System.Text;
 
 namespace VILMacroGenerator
 {
     [Generator]
-    public class MacroGenerator : ISourceGenerator
+    public class MacroGenerator : IIncrementalGenerator
     {
         public const string VilCategory = "VIL";
-        private const string ResultsId = "VIL001";
-        private const string GeneratedId = "VIL002";
         private const string HeaderParseFailId = "VIL010";
         private const string GenerateFailId = "VIL011";
         public const string OldPushFormatId = "VIL020";
 
-
-        private sealed class MacroInfo
+        /// <summary>
+        /// The only parts of vil.h that affect generated code: a @GENERATE header line and the .macro/.function line after it.
+        /// Value equality lets the pipeline skip regenerating definitions that didn't change, including when only a body changed.
+        /// </summary>
+        private readonly struct Definition : IEquatable<Definition>
         {
-            public enum InstructionParamType
+            public string HeaderLine { get; }
+            public string DeclarationLine { get; }
+
+            public Definition(string headerLine, string declarationLine)
             {
-                None,
-                Single,
-                Multiple
+                HeaderLine = headerLine;
+                DeclarationLine = declarationLine;
             }
 
-            public int PushCount { get; set; }
-            public int PopCount { get; set; }
-            public InstructionParamType InstructionParam { get; set; } = InstructionParamType.Single;
+            public bool Equals(Definition other) => HeaderLine == other.HeaderLine && DeclarationLine == other.DeclarationLine;
+            public override bool Equals(object? obj) => obj is Definition other && Equals(other);
+            public override int GetHashCode() => (HeaderLine, DeclarationLine).GetHashCode();
         }
 
-        public void Execute(GeneratorExecutionContext context)
+        /// <summary>Generated source for one definition, or the diagnostic explaining why there isn't any.</summary>
+        private sealed class GenerationResult : IEquatable<GenerationResult>
         {
-            InfoDianostic(context, "HELLO!??!?!?!", "hi");
-            var vilLines = context.AdditionalFiles.Single(f => f.Path.Contains("vil.h")).GetText()!.ToString().Split(new[] { Environment.NewLine }, StringSplitOptions.RemoveEmptyEntries).ToImmutableArray();
-            var generated = FetchMacrosToGenerate(vilLines, context).ToArray();
-            foreach (var tuple in generated)
+            public string Name { get; }
+            public string? Source { get; }
+            public VilDiagnostic? Diagnostic { get; }
+
+            public GenerationResult(string name, string? source, VilDiagnostic? diagnostic)
             {
-                context.AddSource(tuple.Name, SourceText.From(tuple.Source, Encoding.UTF8));
+                Name = name;
+                Source = source;
+                Diagnostic = diagnostic;
             }
-            context.ReportDiagnostic(Diagnostic.Create(new DiagnosticDescriptor(ResultsId, "Results", "Generated {0} macros/functions: {1}", VilCategory, DiagnosticSeverity.Warning, true), null, generated.Length, string.Join(", ", generated.Select(p => p.Name).OrderBy(n => n))));
-            HelloWorld(context);
-            context.ReportDiagnostic(Diagnostic.Create(new DiagnosticDescriptor("VI0011", "Macro Generator Finished", "See previous diagnostics for results.", "VIL", DiagnosticSeverity.Warning, true), null));
+
+            public bool Equals(GenerationResult? other) => other != null && Name == other.Name && Source == other.Source && Equals(Diagnostic, other.Diagnostic);
+            public override bool Equals(object? obj) => Equals(obj as GenerationResult);
+            public override int GetHashCode() => (Name, Source, Diagnostic).GetHashCode();
         }
 
-        public void Initialize(GeneratorInitializationContext context)
+        public void Initialize(IncrementalGeneratorInitializationContext context)
         {
+            // Only re-split when vil.h itself changes, edits to C# files never reach this.
+            var definitions = context.AdditionalTextsProvider
+                .Where(file => Path.GetFileName(file.Path).Equals("vil.h", StringComparison.OrdinalIgnoreCase))
+                .SelectMany((file, cancellationToken) => FetchDefinitions(file.GetText(cancellationToken)?.ToString() ?? ""));
+
+            // Cached per definition, so only added or edited headers get re-parsed and regenerated.
+            var results = definitions.Select((definition, _) => Generate(definition));
+
+            context.RegisterSourceOutput(results, (sourceContext, result) =>
+            {
+                if (result.Diagnostic != null)
+                    sourceContext.ReportDiagnostic(result.Diagnostic.ToDiagnostic());
+                if (result.Source != null)
+                    sourceContext.AddSource(result.Name, SourceText.From(result.Source, Encoding.UTF8));
+            });
         }
 
-        private IEnumerable<(string Name, string Source)> FetchMacrosToGenerate(ImmutableArray<string> lines, GeneratorExecutionContext context)
+        private static ImmutableArray<Definition> FetchDefinitions(string vilText)
         {
-            Header? header = null;
-            foreach (var line in lines)
+            var builder = ImmutableArray.CreateBuilder<Definition>();
+            string? headerLine = null;
+            foreach (var line in vilText.Split('\n').Select(l => l.TrimEnd('\r')).Where(l => l.Length > 0))
             {
                 if (line.Contains("@GENERATE"))
-                {
-                    try
-                    {
-                        header = Header.Parse(line, context);
-                    }
-                    catch (Exception e)
-                    {
-                        var desc = new DiagnosticDescriptor(HeaderParseFailId, "Header parse failed", "Exception thrown when parsing line \"{0}\": {1}", VilCategory, DiagnosticSeverity.Error, true);
-                        context.ReportDiagnostic(Diagnostic.Create(desc, null, line, e.ToString()));
-                    }
-                }
+                    headerLine = line;
 
                 var isMacro = line.Contains(".macro");
                 var isFunction = line.Contains(".function");
-                if (header != null && (isMacro || isFunction))
+                if (headerLine != null && (isMacro || isFunction))
                 {
-                    var name = line.Split(' ').FirstOrDefault();
-                    string? source;
-                    try
-                    {
-                        source = isMacro ? GenerateMacro(line, header, context)
-                            : GenerateFunction(line, header, context);
-                    } 
-                    catch (Exception e)
-                    {
-                        var desc = new DiagnosticDescriptor(GenerateFailId, $"{(isMacro ? "Macro" : "Function")} generation failed", "Exception thrown when generating \"{0}\": {1}", VilCategory, DiagnosticSeverity.Error, true);
-                        context.ReportDiagnostic(Diagnostic.Create(desc, null, name, e.ToString()));
-                        source = null;
-                    }
-                    if (source != null)
-                    {
-                        yield return (name, source);
-                    }
-                    header = null;
+                    builder.Add(new Definition(headerLine, line));
+                    headerLine = null;
                 }
             }
+            return builder.ToImmutable();
+        }
+
+        private GenerationResult Generate(Definition definition)
+        {
+            var line = definition.DeclarationLine;
+            var name = line.Split(' ').First();
+
+            Header? header;
+            try
+            {
+                header = Header.Parse(definition.HeaderLine, out var parseDiagnostic);
+                if (header == null)
+                    return new GenerationResult(name, null, parseDiagnostic);
+            }
+            catch (Exception e)
+            {
+                return new GenerationResult(name, null, new VilDiagnostic(HeaderParseFailId, "Header parse failed", $"Exception thrown when parsing line \"{definition.HeaderLine}\": {e}"));
+            }
+
+            var isMacro = line.Contains(".macro");
+            try
+            {
+                var source = isMacro ? GenerateMacro(line, header) : GenerateFunction(line, header);
+                return new GenerationResult(name, source, null);
+            }
+            catch (Exception e)
+            {
+                return new GenerationResult(name, null, new VilDiagnostic(GenerateFailId, $"{(isMacro ? "Macro" : "Function")} generation failed", $"Exception thrown when generating \"{name}\": {e}"));
+            }
         }
 
-        private string? GenerateFunction(string source, Header header, GeneratorExecutionContext context)
+        private string? GenerateFunction(string source, Header header)
         {
             var annotationsBuilder = new StringBuilder();
             if (header.DeprecatedString == "")
@@ -143,7 +172,7 @@ namespace VCSFramework
 }}";
         }
 
-        private string? GenerateMacro(string source, Header header, GeneratorExecutionContext context)
+        private string? GenerateMacro(string source, Header header)
         {
             var annotationsBuilder = new StringBuilder();
             annotationsBuilder.AppendLine($"\t[PushStack(Count = {(header.TypeParam != null ? 1 : 0)})]");
@@ -248,45 +277,5 @@ namespace VCSFramework
             else
                 throw new ArgumentException($"Could not determine type of: {variableName}");
         }
-
-        private void InfoDianostic(GeneratorExecutionContext context, string title, string message)
-        {
-            context.ReportDiagnostic(Diagnostic.Create(new DiagnosticDescriptor("VI0012", title, message, "VIL", DiagnosticSeverity.Info, true), null));
-        }
-
-        private void HelloWorld(GeneratorExecutionContext context)
-        {
-            // begin creating the source we'll inject into the users compilation
-            var sourceBuilder = new StringBuilder(@"
-using System;
-namespace HelloWorldGenerated
-{
-    public static class HelloWorld
-    {
-        public static void SayHello() 
-        {
-            Console.WriteLine(""Hello from generated code!"");
-            Console.WriteLine(""The following syntax trees existed in the compilation that created this program:"");
-");
-
-            // using the context, get a list of syntax trees in the users compilation
-            var syntaxTrees = context.Compilation.SyntaxTrees;
-
-            // add the filepath of each tree to the class we're building
-            foreach (SyntaxTree tree in syntaxTrees)
-            {
-                sourceBuilder.AppendLine($@"Console.WriteLine(@"" - {tree.FilePath}"");");
-            }
-
-            // finish creating the source to inject
-            sourceBuilder.Append(@"
-        }
-    }
-}");
-
-            // inject the created source into the users compilation
-            context.AddSource("helloWorldGenerator", SourceText.From(sourceBuilder.ToString(), Encoding.UTF8));
-            context.ReportDiagnostic(Diagnostic.Create(new DiagnosticDescriptor("TT0000", "AAA", "BBB", "TEST", DiagnosticSeverity.Warning, true), null));
-        }
     }
 }
@@ -0,0 +1,34 @@
+﻿#nullable enable
+using Microsoft.CodeAnalysis;
+using System;
+
+namespace VILMacroGenerator
+{
+    /// <summary>
+    /// A diagnostic that hasn't been reported yet. Unlike <see cref="Diagnostic"/> this compares by value, so it can
+    /// flow through the incremental pipeline without defeating its caching.
+    /// </summary>
+    internal sealed class VilDiagnostic : IEquatable<VilDiagnostic>
+    {
+        public string Id { get; }
+        public string Title { get; }
+        public string Message { get; }
+
+        public VilDiagnostic(string id, string title, string message)
+        {
+            Id = id;
+            Title = title;
+            Message = message;
+        }
+
+        public Diagnostic ToDiagnostic()
+        {
+            var descriptor = new DiagnosticDescriptor(Id, Title, "{0}", MacroGenerator.VilCategory, DiagnosticSeverity.Error, true);
+            return Diagnostic.Create(descriptor, null, Message);
+        }
+
+        public bool Equals(VilDiagnostic? other) => other != null && Id == other.Id && Title == other.Title && Message == other.Message;
+        public override bool Equals(object? obj) => Equals(obj as VilDiagnostic);
+        public override int GetHashCode() => (Id, Title, Message).GetHashCode();
+    }
+}
@@ -0,0 +1,203 @@
+#nullable enable
+using System;
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.Linq;
+using System.Text;
+
+namespace VILSuperoptimizer
+{
+    /// <summary>
+    /// Writes superoptimized sequences out as composite macros in vil.h and as the optimizer rules that fuse them,
+    /// in VCSCompiler/Optimizations.Superoptimized.cs.
+    /// </summary>
+    internal static class Emitter
+    {
+        public const string BeginMarker = "// BEGIN SUPEROPTIMIZED MACROS";
+        public const string EndMarker = "// END SUPEROPTIMIZED MACROS";
+        private static readonly string[] Ordinals = { "first", "second", "third" };
+
+        /// <summary>Longer sequences first, so they get fused before a shorter rule takes part of them.</summary>
+        public static ImmutableArray<SearchResult> Order(IEnumerable<SearchResult> results)
+            => results
+                .OrderByDescending(r => r.Specification.Macros.Length)
+                .ThenByDescending(r => r.Specification.Count)
+                .ThenBy(r => r.Specification.Shape, StringComparer.Ordinal)
+                .ToImmutableArray();
+
+        /// <summary>e.g. fusedPushGlobalPushConstantAddFromStackPopToGlobalG0C0G0. The operand signature keeps differently aliased shapes apart.</summary>
+        public static string MacroName(Specification specification)
+        {
+            var names = string.Concat(specification.Macros.Select(m => Capitalize(m.Name)));
+            var signature = string.Concat(specification.Macros.SelectMany(m => m.Tokens).Where(t => t[0] is 'g' or 'c').Select(t => t.ToUpperInvariant()));
+            return $"fused{names}{signature}";
+        }
+
+        /// <summary>Replaces everything between the markers in vil.h, adding the markers at the end if they're missing.</summary>
+        public static string RewriteVilHeader(string vilText, IEnumerable<SearchResult> results)
+        {
+            var newLine = vilText.Contains("\r\n") ? "\r\n" : "\n";
+            var lines = vilText.Split(newLine).ToList();
+            var begin = lines.FindIndex(l => l.Trim() == BeginMarker);
+            var end = lines.FindIndex(l => l.Trim() == EndMarker);
+            if (begin < 0 || end < begin)
+            {
+                lines.AddRange(new[] { "", BeginMarker, EndMarker });
+                begin = lines.Count - 2;
+                end = lines.Count - 1;
+            }
+
+            var region = new List<string>
+            {
+                BeginMarker,
+                "// Composite macros found by VILSuperoptimizer. Everything between these markers is regenerated by the tool, do not edit by hand."
+            };
+            foreach (var result in Order(results))
+                region.AddRange(CreateMacro(result).Prepend(""));
+            region.Add(EndMarker);
+
+            lines.RemoveRange(begin, end - begin + 1);
+            lines.InsertRange(begin, region);
+            return string.Join(newLine, lines);
+        }
+
+        public static string CreateOptimizationsSource(IEnumerable<SearchResult> results)
+        {
+            var builder = new StringBuilder();
+            builder.AppendLine("// <auto-generated>");
+            builder.AppendLine("// Generated by VILSuperoptimizer from the macro sequences most common in Samples. Do not edit by hand, rerun the tool instead.");
+            builder.AppendLine("// Each rule fuses a sequence into the matching composite macro in the superoptimized section of vil.h.");
+            builder.AppendLine("// </auto-generated>");
+            builder.AppendLine("#nullable enable");
+            builder.AppendLine("using System.Collections.Immutable;");
+            builder.AppendLine("using System.Linq;");
+            builder.AppendLine("using VCSFramework;");
+            builder.AppendLine();
+            builder.AppendLine("namespace VCSCompiler");
+            builder.AppendLine("{");
+            builder.AppendLine("    internal partial class MethodCompiler");
+            builder.AppendLine("    {");
+            builder.AppendLine("        private static readonly ImmutableArray<Optimizer> SuperoptimizedOptimizations = new Optimizer[]");
+            builder.AppendLine("        {");
+            foreach (var result in Order(results))
+                builder.Append(CreateRule(result));
+            builder.AppendLine("        }.ToImmutableArray();");
+            builder.AppendLine();
+            builder.AppendLine("        /// <summary>Superoptimized macros were only verified against distinct, plain RAM globals.</summary>");
+            builder.AppendLine("        private static bool IsSuperoptimizableGlobal(IGlobalLabel global)");
+            builder.AppendLine("            => global is not (PredefinedGlobalLabel or ReservedGlobalLabel or RomDataGlobalLabel);");
+            builder.AppendLine("    }");
+            builder.AppendLine("}");
+            return builder.ToString();
+        }
+
+        private static IEnumerable<string> CreateMacro(SearchResult result)
+        {
+            var specification = result.Specification;
+            var header = "// @GENERATE @COMPOSITE";
+            if (specification.NetPush == 1)
+                header += " @PUSH=type[byte];size[byte]";
+            if (result.UsesReserved)
+                header += " @RESERVED=1";
+            yield return header;
+            yield return $"// {string.Join(" + ", specification.Macros.Select(m => $".{m.Name}"))}";
+            yield return $"// Superoptimized: {result.Cycles} cycles/{result.Bytes} bytes, was {result.ReferenceCycles} cycles/{result.ReferenceBytes} bytes. Seen {specification.Count} times.";
+            yield return $"{MacroName(specification)} .macro {string.Join(", ", MacroParameters(specification))}";
+            foreach (var instruction in result.Instructions)
+                yield return $"\t{instruction.ToAssembly(ParameterName)}";
+            yield return ".endmacro";
+        }
+
+        private static IEnumerable<string> MacroParameters(Specification specification)
+        {
+            for (var i = 0; i < specification.GlobalCount; i++)
+                yield return ParameterName(new Operand(OperandKind.Global, i));
+            for (var i = 0; i < specification.ConstantCount; i++)
+                yield return ParameterName(new Operand(OperandKind.Constant, i));
+            if (specification.Branch != null)
+                yield return ParameterName(Operand.BranchTarget);
+        }
+
+        public static string ParameterName(Operand operand) => operand.Kind switch
+        {
+            OperandKind.Global => $"{Ordinals[operand.Value]}Global",
+            OperandKind.Constant => $"{Ordinals[operand.Value]}Constant",
+            OperandKind.BranchTarget => "branchTarget",
+            _ => throw new ArgumentException($"'{operand}' isn't a macro parameter.")
+        };
+
+        private static string CreateRule(SearchResult result)
+        {
+            var specification = result.Specification;
+            var guards = new List<string>();
+            var patterns = new List<string>();
+            var seenGlobals = new HashSet<int>();
+            var aliasCount = 0;
+            var sizeCount = 0;
+            for (var i = 0; i < specification.Macros.Length; i++)
+            {
+                var macro = specification.Macros[i];
+                var parameters = macro.Tokens.Select(token =>
+                {
+                    if (token[0] == 'g')
+                    {
+                        var index = int.Parse(token[1..]);
+                        if (seenGlobals.Add(index))
+                        {
+                            guards.Add($"IsSuperoptimizableGlobal(global{index})");
+                            return $"var global{index}";
+                        }
+                        var alias = $"alias{aliasCount++}";
+                        guards.Add($"{alias}.Equals(global{index})");
+                        return $"var {alias}";
+                    }
+                    if (token[0] == 'c')
+                        return $"var constant{token[1..]}";
+                    if (token == "1")
+                    {
+                        var size = $"size{sizeCount++}";
+                        guards.Add($"MacroSequences.IsByteSized({size})");
+                        return $"var {size}";
+                    }
+                    if (token == "b")
+                        return "var branchTarget";
+                    return "_";
+                }).ToList();
+                patterns.Add($"({Capitalize(macro.Name)}(var inst{i}{string.Concat(parameters.Select(p => $", {p}"))}),");
+            }
+            // The macro was verified assuming each global is a different address.
+            for (var i = 0; i < specification.GlobalCount; i++)
+            {
+                for (var j = i + 1; j < specification.GlobalCount; j++)
+                    guards.Add($"!global{i}.Equals(global{j})");
+            }
+
+            var instructions = string.Join(".Concat", Enumerable.Range(0, specification.Macros.Length).Select(i => i == 0 ? "inst0" : $"(inst{i})"));
+            var arguments = Enumerable.Range(0, specification.GlobalCount).Select(i => $"global{i}")
+                .Concat(Enumerable.Range(0, specification.ConstantCount).Select(i => $"constant{i}"))
+                .Concat(specification.Branch != null ? new[] { "branchTarget" } : Array.Empty<string>())
+                .Prepend(instructions);
+
+            var builder = new StringBuilder();
+            builder.AppendLine($"            // {specification.Shape}");
+            builder.AppendLine("            (_, next) => next switch");
+            builder.AppendLine("            {");
+            for (var i = 0; i < patterns.Count; i++)
+            {
+                var pattern = patterns[i];
+                if (i == patterns.Count - 1)
+                    pattern += $" var trueNext){new string(')', patterns.Count - 1)}";
+                builder.AppendLine($"                {pattern}");
+            }
+            if (guards.Any())
+                builder.AppendLine($"                    when {string.Join(" && ", guards)}");
+            builder.AppendLine($"                    => new(new {Capitalize(MacroName(specification))}({string.Join(", ", arguments)}), trueNext),");
+            builder.AppendLine("                _ => next");
+            builder.AppendLine("            },");
+            builder.AppendLine();
+            return builder.ToString();
+        }
+
+        private static string Capitalize(string name) => char.ToUpperInvariant(name[0]) + name[1..];
+    }
+}
@@ -0,0 +1,288 @@
+#nullable enable
+using System;
+
+namespace VILSuperoptimizer
+{
+    internal enum Opcode
+    {
+        LDA, ADC, SBC, AND, ORA, EOR, CMP,
+        STA,
+        INC, DEC, ASL, LSR, ROL, ROR,
+        CLC, SEC, PHA, PLA,
+        BCC, BCS, BEQ, BNE, BMI, BPL
+    }
+
+    internal enum OperandKind
+    {
+        None,
+        Accumulator,
+        /// <summary>A literal immediate value, e.g. #$FF.</summary>
+        Immediate,
+        /// <summary>An immediate value that's a constant parameter of the macro.</summary>
+        Constant,
+        /// <summary>A zero-page global that's a parameter of the macro.</summary>
+        Global,
+        /// <summary>INTERNAL_RESERVED_0, scratch space that isn't observable after the macro.</summary>
+        Reserved,
+        BranchTarget
+    }
+
+    internal sealed record Operand(OperandKind Kind, int Value = 0)
+    {
+        public static readonly Operand None = new(OperandKind.None);
+        public static readonly Operand Accumulator = new(OperandKind.Accumulator);
+        public static readonly Operand Reserved = new(OperandKind.Reserved);
+        public static readonly Operand BranchTarget = new(OperandKind.BranchTarget);
+
+        public bool IsImmediate => Kind is OperandKind.Immediate or OperandKind.Constant;
+        public bool IsMemory => Kind is OperandKind.Global or OperandKind.Reserved;
+    }
+
+    /// <summary>
+    /// A 6502 instruction over symbolic operands. Only the instructions VIL macros use on 1-byte values are modeled.
+    /// X/Y are deliberately left out, so composites never compete with the register allocator.
+    /// </summary>
+    /// <param name="LongBranch">True for 6502.Net's JEQ/JNE/etc., which assemble into an inverted branch over a JMP.</param>
+    internal sealed record Instruction(Opcode Opcode, Operand Operand, bool LongBranch = false)
+    {
+        public bool IsBranch => Opcode is Opcode.BCC or Opcode.BCS or Opcode.BEQ or Opcode.BNE or Opcode.BMI or Opcode.BPL;
+
+        /// <summary>Cycles taken, assuming zero-page operands and a taken branch that doesn't cross a page.</summary>
+        public int Cycles => Opcode switch
+        {
+            Opcode.CLC or Opcode.SEC => 2,
+            Opcode.PHA => 3,
+            Opcode.PLA => 4,
+            Opcode.STA => 3,
+            Opcode.INC or Opcode.DEC or Opcode.ASL or Opcode.LSR or Opcode.ROL or Opcode.ROR => Operand.Kind == OperandKind.Accumulator ? 2 : 5,
+            _ when IsBranch => LongBranch ? 5 : 3,
+            _ => Operand.IsImmediate ? 2 : 3
+        };
+
+        public int Bytes => Opcode switch
+        {
+            Opcode.CLC or Opcode.SEC or Opcode.PHA or Opcode.PLA => 1,
+            _ when IsBranch => LongBranch ? 5 : 2,
+            _ => Operand.Kind == OperandKind.Accumulator ? 1 : 2
+        };
+
+        /// <summary>Formats the instruction as a line of a vil.h macro body.</summary>
+        public string ToAssembly(Func<Operand, string> parameterName)
+        {
+            var mnemonic = IsBranch && LongBranch ? "J" + Opcode.ToString()[1..] : Opcode.ToString();
+            return Operand.Kind switch
+            {
+                OperandKind.None => mnemonic,
+                OperandKind.Accumulator => $"{mnemonic} A",
+                OperandKind.Immediate => Operand.Value switch
+                {
+                    0 or 1 => $"{mnemonic} #{Operand.Value}",
+                    _ => $"{mnemonic} #${Operand.Value:X2}"
+                },
+                OperandKind.Constant => $"{mnemonic} #\\{parameterName(Operand)}",
+                OperandKind.Reserved => $"{mnemonic} INTERNAL_RESERVED_0",
+                _ => $"{mnemonic} \\{parameterName(Operand)}"
+            };
+        }
+    }
+
+    /// <summary>
+    /// The state of the parts of the 6502 that VIL macros can observe, packed so copying it is cheap.
+    /// Decimal mode is assumed off, the entry point clears it and nothing sets it.
+    /// </summary>
+    internal struct MachineState
+    {
+        /// <summary>Byte n holds global n. The last byte holds INTERNAL_RESERVED_0.</summary>
+        public const int ReservedIndex = 7;
+        public const int MaxGlobals = ReservedIndex;
+        public const int MaxStackDepth = 8;
+
+        public byte A;
+        public bool Carry;
+        public bool Zero;
+        public bool Negative;
+        public ulong Memory;
+        /// <summary>Bytes pushed during this sequence, most recent in the low byte.</summary>
+        public ulong Stack;
+        public int StackDepth;
+        /// <summary>Null until a branch executes, then whether it was taken.</summary>
+        public bool? Branched;
+
+        public byte Read(int index) => (byte)(Memory >> (index * 8));
+
+        public void Write(int index, byte value)
+        {
+            var shift = index * 8;
+            Memory = (Memory & ~(0xFFUL << shift)) | ((ulong)value << shift);
+        }
+
+        /// <summary>
+        /// Executes one instruction. Returns false if it can't be executed: popping bytes that weren't pushed by the
+        /// sequence, pushing too deep, or anything after a branch.
+        /// </summary>
+        public bool Execute(Instruction instruction, ulong constants)
+        {
+            if (Branched != null)
+                return false;
+
+            var operand = instruction.Operand;
+            switch (instruction.Opcode)
+            {
+                case Opcode.LDA:
+                    SetNZ(A = Load(operand, constants));
+                    break;
+                case Opcode.ADC:
+                {
+                    var sum = A + Load(operand, constants) + (Carry ? 1 : 0);
+                    Carry = sum > 0xFF;
+                    SetNZ(A = (byte)sum);
+                    break;
+                }
+                case Opcode.SBC:
+                {
+                    var difference = A - Load(operand, constants) - (Carry ? 0 : 1);
+                    Carry = difference >= 0;
+                    SetNZ(A = (byte)difference);
+                    break;
+                }
+                case Opcode.AND:
+                    SetNZ(A &= Load(operand, constants));
+                    break;
+                case Opcode.ORA:
+                    SetNZ(A |= Load(operand, constants));
+                    break;
+                case Opcode.EOR:
+                    SetNZ(A ^= Load(operand, constants));
+                    break;
+                case Opcode.CMP:
+                {
+                    var value = Load(operand, constants);
+                    Carry = A >= value;
+                    SetNZ((byte)(A - value));
+                    break;
+                }
+                case Opcode.STA:
+                    Write(MemoryIndex(operand), A);
+                    break;
+                case Opcode.INC:
+                case Opcode.DEC:
+                case Opcode.ASL:
+                case Opcode.LSR:
+                case Opcode.ROL:
+                case Opcode.ROR:
+                {
+                    var isAccumulator = operand.Kind == OperandKind.Accumulator;
+                    var value = isAccumulator ? A : Read(MemoryIndex(operand));
+                    var result = ReadModifyWrite(instruction.Opcode, value);
+                    if (isAccumulator)
+                        A = result;
+                    else
+                        Write(MemoryIndex(operand), result);
+                    SetNZ(result);
+                    break;
+                }
+                case Opcode.CLC:
+                    Carry = false;
+                    break;
+                case Opcode.SEC:
+                    Carry = true;
+                    break;
+                case Opcode.PHA:
+                    if (StackDepth == MaxStackDepth)
+                        return false;
+                    Stack = (Stack << 8) | A;
+                    StackDepth++;
+                    break;
+                case Opcode.PLA:
+                    if (StackDepth == 0)
+                        return false;
+                    SetNZ(A = (byte)Stack);
+                    Stack >>= 8;
+                    StackDepth--;
+                    break;
+                case Opcode.BCC:
+                    Branched = !Carry;
+                    break;
+                case Opcode.BCS:
+                    Branched = Carry;
+                    break;
+                case Opcode.BEQ:
+                    Branched = Zero;
+                    break;
+                case Opcode.BNE:
+                    Branched = !Zero;
+                    break;
+                case Opcode.BMI:
+                    Branched = Negative;
+                    break;
+                case Opcode.BPL:
+                    Branched = !Negative;
+                    break;
+                default:
+                    throw new ArgumentException($"Unknown opcode: {instruction.Opcode}");
+            }
+            return true;
+        }
+
+        /// <summary>True if everything a caller of the macro could see is the same. A, flags, and INTERNAL_RESERVED_0 are scratch.</summary>
+        public bool IsObservablyEqual(in MachineState other, ulong globalsMask)
+            => (Memory & globalsMask) == (other.Memory & globalsMask)
+            && StackDepth == other.StackDepth
+            && Stack == other.Stack
+            && Branched == other.Branched;
+
+        public static ulong GlobalsMask(int globalCount)
+            => globalCount == 0 ? 0 : ulong.MaxValue >> ((8 - globalCount) * 8);
+
+        private byte Load(Operand operand, ulong constants) => operand.Kind switch
+        {
+            OperandKind.Immediate => (byte)operand.Value,
+            OperandKind.Constant => (byte)(constants >> (operand.Value * 8)),
+            _ => Read(MemoryIndex(operand))
+        };
+
+        private static int MemoryIndex(Operand operand) => operand.Kind switch
+        {
+            OperandKind.Global => operand.Value,
+            OperandKind.Reserved => ReservedIndex,
+            _ => throw new ArgumentException($"Operand '{operand}' isn't a memory location.")
+        };
+
+        private byte ReadModifyWrite(Opcode opcode, byte value)
+        {
+            switch (opcode)
+            {
+                case Opcode.INC:
+                    return (byte)(value + 1);
+                case Opcode.DEC:
+                    return (byte)(value - 1);
+                case Opcode.ASL:
+                    Carry = (value & 0x80) != 0;
+                    return (byte)(value << 1);
+                case Opcode.LSR:
+                    Carry = (value & 0x01) != 0;
+                    return (byte)(value >> 1);
+                case Opcode.ROL:
+                {
+                    var result = (byte)((value << 1) | (Carry ? 1 : 0));
+                    Carry = (value & 0x80) != 0;
+                    return result;
+                }
+                case Opcode.ROR:
+                {
+                    var result = (byte)((value >> 1) | (Carry ? 0x80 : 0));
+                    Carry = (value & 0x01) != 0;
+                    return result;
+                }
+                default:
+                    throw new ArgumentException($"'{opcode}' isn't a read-modify-write instruction.");
+            }
+        }
+
+        private void SetNZ(byte value)
+        {
+            Zero = value == 0;
+            Negative = (value & 0x80) != 0;
+        }
+    }
+}
@@ -0,0 +1,158 @@
+﻿#nullable enable
+using System;
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.Diagnostics;
+using System.IO;
+using System.Linq;
+using System.Text;
+using VCSCompiler;
+
+namespace VILSuperoptimizer
+{
+    class Program
+    {
+        /// <summary>
+        /// Compiles every sample, finds the most common runs of adjacent VIL macros, and searches for the cheapest
+        /// 6502 sequence equivalent to each. Anything cheaper than the current expansion is written to vil.h as a
+        /// composite macro, along with an optimizer rule in VCSCompiler that fuses the run into it.
+        /// Previously generated macros and rules are replaced, so rebuild VCSCompiler after running this.
+        /// </summary>
+        /// <param name="samplesDirectory">Directory to search for sample .cs files. Defaults to the repo's Samples directory.</param>
+        /// <param name="vilPath">vil.h to read macro declarations from and write composites into. Defaults to VCSFramework/vil.h.</param>
+        /// <param name="rulesPath">File to write the optimizer rules to. Defaults to VCSCompiler/Optimizations.Superoptimized.cs.</param>
+        /// <param name="top">How many of the most common sequences to superoptimize.</param>
+        /// <param name="minCount">Sequences seen fewer times than this across all samples are ignored.</param>
+        /// <param name="maxLength">Longest instruction sequence to search, not counting a final branch. Search time grows exponentially with this.</param>
+        /// <param name="optimizeFor">Whether to minimize cycles or bytes. The other is used to break ties.</param>
+        /// <param name="dryRun">Print what would be generated without writing any files.</param>
+        static int Main(
+            string? samplesDirectory = null,
+            string? vilPath = null,
+            string? rulesPath = null,
+            int top = 10,
+            int minCount = 2,
+            int maxLength = 4,
+            CostMetric optimizeFor = CostMetric.Cycles,
+            bool dryRun = false)
+        {
+            var repoRoot = FindRepoRoot();
+            samplesDirectory ??= Path.Combine(repoRoot, "Samples");
+            vilPath ??= Path.Combine(repoRoot, "VCSFramework", "vil.h");
+            rulesPath ??= Path.Combine(repoRoot, "VCSCompiler", "Optimizations.Superoptimized.cs");
+
+            var vilText = File.ReadAllText(vilPath);
+            var vilLines = vilText.Split('\n').Select(l => l.TrimEnd('\r')).ToImmutableArray();
+            var modelErrors = Specification.CheckMacroBodies(vilLines);
+            if (modelErrors.Any())
+            {
+                foreach (var error in modelErrors)
+                    Console.Error.WriteLine(error);
+                Console.Error.WriteLine("Update Specification.MacroBodies to match vil.h before superoptimizing.");
+                return 1;
+            }
+            var macroParameters = Specification.ReadMacroParameters(vilLines);
+
+            var sequenceCounts = MineSequences(samplesDirectory);
+            Console.WriteLine($"Found {sequenceCounts.Count} distinct macro sequences.");
+
+            var specifications = new List<Specification>();
+            foreach (var (shape, count) in sequenceCounts.Where(p => p.Value >= minCount).OrderByDescending(p => p.Value).ThenBy(p => p.Key, StringComparer.Ordinal))
+            {
+                if (specifications.Count == top)
+                    break;
+                var specification = Specification.TryCreate(shape, count, macroParameters, out _);
+                if (specification == null)
+                    continue;
+                if (specification.InputCount > Superoptimizer.MaxInputs)
+                {
+                    Console.WriteLine($"Skipping {shape}: {specification.InputCount} inputs is too many to check exhaustively.");
+                    continue;
+                }
+                specifications.Add(specification);
+            }
+            Console.WriteLine($"Superoptimizing {specifications.Count} sequences.");
+
+            var results = new List<SearchResult>();
+            foreach (var specification in specifications)
+            {
+                var stopwatch = Stopwatch.StartNew();
+                var result = new Superoptimizer(specification, optimizeFor, maxLength).Run();
+                stopwatch.Stop();
+                Console.WriteLine($"[{specification.Count,4}x] {specification.Shape}");
+                if (result == null)
+                {
+                    Console.WriteLine($"        Nothing cheaper than {specification.ReferenceWithBranch.Length} instructions found ({stopwatch.Elapsed.TotalSeconds:0.0}s).");
+                    continue;
+                }
+                Console.WriteLine($"        {result.ReferenceCycles} -> {result.Cycles} cycles, {result.ReferenceBytes} -> {result.Bytes} bytes ({stopwatch.Elapsed.TotalSeconds:0.0}s): {string.Join("; ", result.Instructions.Select(i => i.ToAssembly(Emitter.ParameterName)))}");
+                results.Add(result);
+            }
+
+            if (dryRun)
+            {
+                Console.WriteLine(Emitter.CreateOptimizationsSource(results));
+                return 0;
+            }
+            // vil.h keeps its BOM, like the rest of the sources.
+            File.WriteAllText(vilPath, Emitter.RewriteVilHeader(vilText, results), new UTF8Encoding(true));
+            File.WriteAllText(rulesPath, Emitter.CreateOptimizationsSource(results));
+            Console.WriteLine($"Wrote {results.Count} composite macros to '{vilPath}' and their rules to '{rulesPath}'.");
+            return 0;
+        }
+
+        /// <summary>
+        /// Compiles each sample with optimizations on, but without the existing superoptimized rules, so the sequences they
+        /// already cover still get counted (and regenerated).
+        /// </summary>
+        private static ImmutableDictionary<string, int> MineSequences(string samplesDirectory)
+        {
+            var samples = Directory.EnumerateFiles(samplesDirectory, "*.cs", SearchOption.AllDirectories)
+                .Where(p => !p.Split(Path.DirectorySeparatorChar).Any(d => d == "obj" || d == "bin"))
+                .OrderBy(p => p)
+                .ToImmutableArray();
+
+            var outputDirectory = Path.Combine(Path.GetTempPath(), "VILSuperoptimizer");
+            Directory.CreateDirectory(outputDirectory);
+
+            var counts = new Dictionary<string, int>();
+            foreach (var sample in samples)
+            {
+                var options = new CompilerOptions
+                {
+                    OutputPath = Path.Combine(outputDirectory, $"{Path.GetFileNameWithoutExtension(sample)}.bin"),
+                    DisableSuperoptimizations = true,
+                    Log = TextWriter.Null
+                };
+                RomInfo romInfo;
+                try
+                {
+                    romInfo = Compiler.CompileFromFile(sample, options);
+                }
+                catch (Exception e)
+                {
+                    Console.WriteLine($"Compiling '{sample}' threw: {e.Message}");
+                    continue;
+                }
+                if (!romInfo.IsSuccessful)
+                {
+                    Console.WriteLine($"Compiling '{sample}' failed, its sequences won't be counted.");
+                    continue;
+                }
+                foreach (var (shape, count) in romInfo.Statistics.MacroSequenceCounts)
+                    counts[shape] = counts.TryGetValue(shape, out var existing) ? existing + count : count;
+            }
+            return counts.ToImmutableDictionary();
+        }
+
+        private static string FindRepoRoot()
+        {
+            for (var directory = new DirectoryInfo(AppContext.BaseDirectory); directory != null; directory = directory.Parent)
+            {
+                if (File.Exists(Path.Combine(directory.FullName, "CSharpTo2600.sln")))
+                    return directory.FullName;
+            }
+            return Directory.GetCurrentDirectory();
+        }
+    }
+}
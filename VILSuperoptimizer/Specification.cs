@@ -0,0 +1,314 @@
+﻿#nullable enable
+using System;
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.Linq;
+using System.Text.RegularExpressions;
+
+namespace VILSuperoptimizer
+{
+    internal sealed record ShapeMacro(string Name, ImmutableArray<string> ParameterNames, ImmutableArray<string> Tokens);
+
+    /// <summary>
+    /// What a macro sequence does, as the 6502 code it currently expands to. Produced from a shape recorded by the compiler
+    /// (see VCSCompiler.MacroSequences) and the 1-byte paths of the macros in vil.h.
+    /// </summary>
+    internal sealed record Specification(
+        string Shape,
+        int Count,
+        ImmutableArray<ShapeMacro> Macros,
+        int GlobalCount,
+        int ConstantCount,
+        ImmutableArray<Instruction> Reference,
+        Instruction? Branch,
+        int NetPush)
+    {
+        /// <summary>Globals and constants, each of which is exhaustively tested over all 256 values.</summary>
+        public int InputCount => GlobalCount + ConstantCount;
+        public ImmutableArray<Instruction> ReferenceWithBranch => Branch != null ? Reference.Add(Branch) : Reference;
+
+        private static readonly Regex MacroDeclarationRegex = new(@"^(\w+)\s+\.macro\b(.*)$");
+        private static readonly Regex ConditionalDirectiveRegex = new(@"^\.(if|elseif|else|endif)\b", RegexOptions.IgnoreCase);
+        private static readonly Regex AnonymousLabelRegex = new(@"^[+-]+$");
+        private static readonly Regex SymbolRegex = new(@"^[A-Za-z_]\w*$");
+        private static readonly Regex ShapeMacroRegex = new(@"^(\w+)\((.*)\)$");
+        private static readonly Regex GlobalTokenRegex = new(@"^g(\d+)$");
+        private static readonly Regex ConstantTokenRegex = new(@"^c(\d+)$");
+
+        /// <summary>
+        /// The 1-byte expansion of each macro that can appear in a fused sequence, transcribed from vil.h. Parameters are
+        /// referenced the same way vil.h does. Macros that branch internally, use X/Y, or touch memory through pointers
+        /// aren't modeled, so sequences containing them are never fused. <see cref="CheckMacroBodies"/> verifies these
+        /// against vil.h before anything is searched.
+        /// </summary>
+        private static readonly ImmutableDictionary<string, string> MacroBodies = new Dictionary<string, string>
+        {
+            ["pushGlobal"] = "LDA \\global; PHA",
+            ["pushConstant"] = "LDA #\\constant; PHA",
+            ["popToGlobal"] = "PLA; STA \\global",
+            ["copyGlobalToGlobal"] = "LDA \\fromGlobal; STA \\toGlobal",
+            ["assignConstantToGlobal"] = "LDA #\\constant; STA \\global",
+            ["incrementGlobal"] = "INC \\global",
+            ["addFromStack"] = "PLA; STA INTERNAL_RESERVED_0; PLA; CLC; ADC INTERNAL_RESERVED_0; PHA",
+            ["subFromStack"] = "PLA; STA INTERNAL_RESERVED_0; PLA; SEC; SBC INTERNAL_RESERVED_0; PHA",
+            ["orFromStack"] = "PLA; STA INTERNAL_RESERVED_0; PLA; ORA INTERNAL_RESERVED_0; PHA",
+            ["andFromStack"] = "PLA; STA INTERNAL_RESERVED_0; PLA; AND INTERNAL_RESERVED_0; PHA",
+            ["negateFromStack"] = "PLA; STA INTERNAL_RESERVED_0; LDA #$FF; SEC; SBC INTERNAL_RESERVED_0; CLC; ADC #1; PHA",
+            ["branchIfLessThanFromStack"] = "PLA; STA INTERNAL_RESERVED_0; PLA; CMP INTERNAL_RESERVED_0; BCC \\branchTarget",
+            ["branchTrueFromStack"] = "PLA; JNE \\branchTarget",
+            ["branchFalseFromStack"] = "PLA; JEQ \\branchTarget",
+        }.ToImmutableDictionary();
+
+        /// <summary>Reads the parameter names of every macro declared in vil.h.</summary>
+        public static ImmutableDictionary<string, ImmutableArray<string>> ReadMacroParameters(IEnumerable<string> vilLines)
+        {
+            var parameters = new Dictionary<string, ImmutableArray<string>>();
+            foreach (var rawLine in vilLines)
+            {
+                var commentStart = rawLine.IndexOf("//", StringComparison.Ordinal);
+                var line = (commentStart >= 0 ? rawLine[..commentStart] : rawLine).Trim();
+                var match = MacroDeclarationRegex.Match(line);
+                if (!match.Success)
+                    continue;
+                parameters[match.Groups[1].Value] = match.Groups[2].Value
+                    .Split(',')
+                    .Select(p => p.Trim())
+                    .Where(p => p.Length > 0)
+                    .ToImmutableArray();
+            }
+            return parameters.ToImmutableDictionary();
+        }
+
+        /// <summary>
+        /// Checks each modeled body against the macro of the same name in vil.h, so the transcription can't drift from
+        /// what the assembler actually emits. A body matches if it's one of the macro's paths through its conditionals,
+        /// taking each loop once. A parameter reference matches that parameter, or a symbol vil.h derives from
+        /// parameters with .for/.let. Returns a description of each mismatch.
+        /// </summary>
+        public static ImmutableArray<string> CheckMacroBodies(IEnumerable<string> vilLines)
+        {
+            var macroLines = new Dictionary<string, ImmutableArray<string>.Builder>();
+            ImmutableArray<string>.Builder? currentMacro = null;
+            foreach (var rawLine in vilLines)
+            {
+                var commentStart = rawLine.IndexOf("//", StringComparison.Ordinal);
+                var line = (commentStart >= 0 ? rawLine[..commentStart] : rawLine).Trim();
+                var match = MacroDeclarationRegex.Match(line);
+                if (match.Success)
+                    macroLines[match.Groups[1].Value] = currentMacro = ImmutableArray.CreateBuilder<string>();
+                else if (line.StartsWith(".endmacro", StringComparison.OrdinalIgnoreCase))
+                    currentMacro = null;
+                else if (line.Length > 0)
+                    currentMacro?.Add(line);
+            }
+
+            var errors = ImmutableArray.CreateBuilder<string>();
+            foreach (var (name, body) in MacroBodies.OrderBy(p => p.Key, StringComparer.Ordinal))
+            {
+                if (!macroLines.TryGetValue(name, out var lines))
+                {
+                    errors.Add($"'{name}' is modeled but isn't declared in vil.h.");
+                    continue;
+                }
+                var modeled = body.Split(';').Select(l => l.Trim()).ToImmutableArray();
+                var index = 0;
+                var paths = PathsThrough(lines.ToImmutable(), ref index);
+                if (!paths.Any(path => path.Count == modeled.Length && path.Zip(modeled).All(p => LineMatches(p.Second, p.First))))
+                    errors.Add($"The model of '{name}' ({body}) isn't a path through its body in vil.h.");
+            }
+            return errors.ToImmutable();
+        }
+
+        /// <summary>
+        /// Every straight-line sequence of instructions through a macro body, starting at <paramref name="index"/> and
+        /// stopping at the .elseif/.else/.endif that ends the current block. Other directives and anonymous labels are skipped.
+        /// </summary>
+        private static List<ImmutableList<string>> PathsThrough(ImmutableArray<string> lines, ref int index)
+        {
+            var paths = new List<ImmutableList<string>> { ImmutableList<string>.Empty };
+            while (index < lines.Length)
+            {
+                var line = lines[index];
+                var directive = ConditionalDirectiveRegex.Match(line);
+                if (directive.Success && !directive.Groups[1].Value.Equals("if", StringComparison.OrdinalIgnoreCase))
+                    break;
+                index++;
+                if (directive.Success)
+                {
+                    var branches = new List<ImmutableList<string>>();
+                    var hasElse = false;
+                    while (true)
+                    {
+                        branches.AddRange(PathsThrough(lines, ref index));
+                        if (index == lines.Length)
+                            throw new FormatException($"Unterminated .if in vil.h: '{line}'.");
+                        var end = ConditionalDirectiveRegex.Match(lines[index++]).Groups[1].Value.ToLowerInvariant();
+                        if (end == "endif")
+                            break;
+                        hasElse |= end == "else";
+                    }
+                    if (!hasElse)
+                        branches.Add(ImmutableList<string>.Empty);
+                    paths = paths.SelectMany(p => branches.Select(b => p.AddRange(b))).ToList();
+                }
+                else if (!line.StartsWith('.') && !AnonymousLabelRegex.IsMatch(line))
+                {
+                    paths = paths.Select(p => p.Add(line)).ToList();
+                }
+            }
+            return paths;
+        }
+
+        private static bool LineMatches(string modeled, string vil)
+        {
+            var modeledParts = modeled.Split(' ', 2);
+            var vilParts = vil.Split((char[]?)null, 2, StringSplitOptions.RemoveEmptyEntries);
+            if (modeledParts[0] != vilParts[0] || modeledParts.Length != vilParts.Length)
+                return false;
+            if (modeledParts.Length == 1)
+                return true;
+
+            var modeledOperand = modeledParts[1].Trim();
+            var vilOperand = vilParts[1].Trim();
+            if (modeledOperand == vilOperand)
+                return true;
+            var isImmediate = modeledOperand.StartsWith('#');
+            if (isImmediate != vilOperand.StartsWith('#'))
+                return false;
+            var parameter = isImmediate ? modeledOperand[1..] : modeledOperand;
+            var symbol = isImmediate ? vilOperand[1..] : vilOperand;
+            return parameter.StartsWith('\\') && SymbolRegex.IsMatch(symbol) && !symbol.StartsWith("INTERNAL_RESERVED", StringComparison.Ordinal);
+        }
+
+        /// <summary>
+        /// Builds the specification of a shape, or returns null with the reason it can't be superoptimized.
+        /// </summary>
+        public static Specification? TryCreate(string shape, int count, ImmutableDictionary<string, ImmutableArray<string>> macroParameters, out string reason)
+        {
+            var macros = ImmutableArray.CreateBuilder<ShapeMacro>();
+            foreach (var part in shape.Split(" + "))
+            {
+                var match = ShapeMacroRegex.Match(part);
+                if (!match.Success)
+                {
+                    reason = $"Couldn't parse '{part}'.";
+                    return null;
+                }
+                var name = match.Groups[1].Value;
+                var tokens = match.Groups[2].Value.Length == 0 ? ImmutableArray<string>.Empty : match.Groups[2].Value.Split(',').ToImmutableArray();
+                if (!MacroBodies.ContainsKey(name))
+                {
+                    reason = $"No model for '{name}'.";
+                    return null;
+                }
+                if (!macroParameters.TryGetValue(name, out var parameterNames) || parameterNames.Length != tokens.Length)
+                {
+                    reason = $"'{name}' doesn't match its declaration in vil.h.";
+                    return null;
+                }
+                var unsupported = tokens.FirstOrDefault(t => !(t is "t" or "1" or "s" or "b" || GlobalTokenRegex.IsMatch(t) || ConstantTokenRegex.IsMatch(t)));
+                if (unsupported != null)
+                {
+                    reason = $"'{name}' has a parameter that isn't a 1-byte RAM global or constant ('{unsupported}').";
+                    return null;
+                }
+                macros.Add(new ShapeMacro(name, parameterNames, tokens));
+            }
+
+            var reference = new List<Instruction>();
+            foreach (var macro in macros)
+            {
+                var bindings = macro.ParameterNames.Zip(macro.Tokens).ToImmutableDictionary(p => p.First, p => ToOperand(p.Second));
+                reference.AddRange(MacroBodies[macro.Name].Split(';').Select(line => ParseInstruction(line.Trim(), bindings)));
+            }
+
+            var branchIndex = reference.FindIndex(i => i.IsBranch);
+            if (branchIndex >= 0 && branchIndex != reference.Count - 1)
+            {
+                reason = "Control flow leaves the sequence before its last macro.";
+                return null;
+            }
+
+            var globalCount = CountOf(GlobalTokenRegex);
+            var constantCount = CountOf(ConstantTokenRegex);
+            if (globalCount > MachineState.MaxGlobals)
+            {
+                reason = "Too many globals.";
+                return null;
+            }
+
+            // The sequence has to be self-contained: it may only pop what it pushed, since the size of anything
+            // already on the stack isn't known when the optimizer matches it.
+            var state = new MachineState();
+            foreach (var instruction in reference)
+            {
+                if (!state.Execute(instruction, 0))
+                {
+                    reason = "Pops values it didn't push.";
+                    return null;
+                }
+            }
+            if (state.StackDepth > 1)
+            {
+                reason = "Leaves more than one byte on the stack.";
+                return null;
+            }
+
+            reason = "";
+            var branch = branchIndex >= 0 ? reference[branchIndex] : null;
+            var body = branch != null ? reference.Take(branchIndex) : reference;
+            return new Specification(shape, count, macros.ToImmutable(), globalCount, constantCount, body.ToImmutableArray(), branch, state.StackDepth);
+
+            int CountOf(Regex tokenRegex) => macros
+                .SelectMany(m => m.Tokens)
+                .Select(t => tokenRegex.Match(t))
+                .Where(m => m.Success)
+                .Select(m => int.Parse(m.Groups[1].Value) + 1)
+                .DefaultIfEmpty(0)
+                .Max();
+        }
+
+        private static Operand ToOperand(string token)
+        {
+            var global = GlobalTokenRegex.Match(token);
+            if (global.Success)
+                return new Operand(OperandKind.Global, int.Parse(global.Groups[1].Value));
+            var constant = ConstantTokenRegex.Match(token);
+            if (constant.Success)
+                return new Operand(OperandKind.Constant, int.Parse(constant.Groups[1].Value));
+            if (token == "b")
+                return Operand.BranchTarget;
+            // Types/sizes never appear in the modeled 1-byte bodies.
+            return Operand.None;
+        }
+
+        private static Instruction ParseInstruction(string line, ImmutableDictionary<string, Operand> bindings)
+        {
+            var parts = line.Split(' ', 2);
+            var mnemonic = parts[0];
+            var longBranch = mnemonic.StartsWith('J');
+            var opcode = Enum.Parse<Opcode>(longBranch ? "B" + mnemonic[1..] : mnemonic);
+            if (parts.Length == 1)
+            {
+                var isReadModifyWrite = opcode is Opcode.ASL or Opcode.LSR or Opcode.ROL or Opcode.ROR;
+                return new Instruction(opcode, isReadModifyWrite ? Operand.Accumulator : Operand.None);
+            }
+
+            var operandText = parts[1].Trim();
+            Operand operand;
+            if (operandText == "INTERNAL_RESERVED_0")
+                operand = Operand.Reserved;
+            else if (operandText.StartsWith("#\\"))
+                operand = bindings[operandText[2..]];
+            else if (operandText.StartsWith("#$"))
+                operand = new Operand(OperandKind.Immediate, Convert.ToInt32(operandText[2..], 16));
+            else if (operandText.StartsWith('#'))
+                operand = new Operand(OperandKind.Immediate, int.Parse(operandText[1..]));
+            else if (operandText.StartsWith('\\'))
+                operand = bindings[operandText[1..]];
+            else
+                throw new ArgumentException($"Can't parse operand of '{line}'.");
+            return new Instruction(opcode, operand, longBranch);
+        }
+    }
+}
@@ -0,0 +1,296 @@
+#nullable enable
+using System;
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.Linq;
+
+namespace VILSuperoptimizer
+{
+    internal enum CostMetric
+    {
+        Cycles,
+        Bytes
+    }
+
+    internal sealed record SearchResult(Specification Specification, ImmutableArray<Instruction> Instructions, int Cycles, int Bytes)
+    {
+        public int ReferenceCycles => Specification.ReferenceWithBranch.Sum(i => i.Cycles);
+        public int ReferenceBytes => Specification.ReferenceWithBranch.Sum(i => i.Bytes);
+        public bool UsesReserved => Instructions.Any(i => i.Operand.Kind == OperandKind.Reserved);
+    }
+
+    /// <summary>
+    /// Finds the cheapest sequence of up to <c>maxLength</c> instructions (plus a final branch, if the specification branches)
+    /// that's equivalent to a specification. Candidates are enumerated depth-first with branch-and-bound on cost, filtered
+    /// against a fixed set of test vectors, and survivors are checked against every combination of 8-bit inputs.
+    /// </summary>
+    internal sealed class Superoptimizer
+    {
+        /// <summary>Exhaustive checking covers 256^inputs cases, so more than 3 inputs would take too long.</summary>
+        public const int MaxInputs = 3;
+        private const int FilterVectorCount = 16;
+        private static readonly byte[] InterestingValues = { 0x00, 0x01, 0x02, 0x7F, 0x80, 0x81, 0xFE, 0xFF };
+
+        private readonly Specification Specification;
+        private readonly CostMetric Metric;
+        private readonly int MaxLength;
+        private readonly ImmutableArray<Instruction> Alphabet;
+        private readonly ImmutableArray<Instruction> Branches;
+        private readonly ulong GlobalsMask;
+        private readonly ImmutableArray<(MachineState State, ulong Constants)> Vectors;
+        private readonly ImmutableArray<MachineState> Expected;
+        private readonly MachineState[][] States;
+        private readonly Instruction[] Prefix;
+
+        private (int Primary, int Secondary) BestCost;
+        private ImmutableArray<Instruction>? Best;
+
+        public Superoptimizer(Specification specification, CostMetric metric, int maxLength)
+        {
+            if (specification.InputCount > MaxInputs)
+                throw new ArgumentException($"'{specification.Shape}' has {specification.InputCount} inputs, at most {MaxInputs} can be checked exhaustively.");
+
+            Specification = specification;
+            Metric = metric;
+            MaxLength = maxLength;
+            Alphabet = CreateAlphabet(specification).ToImmutableArray();
+            // Keep the reference's branch form, a short branch might not reach the target.
+            Branches = specification.Branch is Instruction referenceBranch
+                ? new[] { Opcode.BCC, Opcode.BCS, Opcode.BEQ, Opcode.BNE, Opcode.BMI, Opcode.BPL }
+                    .Select(o => new Instruction(o, Operand.BranchTarget, referenceBranch.LongBranch))
+                    .ToImmutableArray()
+                : ImmutableArray<Instruction>.Empty;
+            GlobalsMask = MachineState.GlobalsMask(specification.GlobalCount);
+            Vectors = CreateFilterVectors(specification).ToImmutableArray();
+            Expected = Vectors.Select(v => RunReference(v.State, v.Constants)).ToImmutableArray();
+            States = Enumerable.Range(0, maxLength + 1).Select(_ => new MachineState[Vectors.Length]).ToArray();
+            Prefix = new Instruction[maxLength];
+        }
+
+        /// <summary>Returns the cheapest equivalent sequence, or null if nothing is cheaper than the reference.</summary>
+        public SearchResult? Run()
+        {
+            var reference = Specification.ReferenceWithBranch;
+            BestCost = CostOf(reference);
+            Best = null;
+            for (var i = 0; i < Vectors.Length; i++)
+                States[0][i] = Vectors[i].State;
+            Search(0, (0, 0));
+
+            return Best is ImmutableArray<Instruction> best
+                ? new SearchResult(Specification, best, best.Sum(i => i.Cycles), best.Sum(i => i.Bytes))
+                : null;
+        }
+
+        private void Search(int depth, (int Primary, int Secondary) cost)
+        {
+            var current = States[depth];
+            var next = States[depth + 1];
+            foreach (var instruction in Alphabet)
+            {
+                if (depth > 0 && IsRedundant(Prefix[depth - 1], instruction))
+                    continue;
+                var nextCost = Add(cost, instruction);
+                // Every instruction costs at least 1 of either metric, so nothing below here can beat the best.
+                if (nextCost.CompareTo(BestCost) >= 0)
+                    continue;
+                if (!TryExecute(current, next, instruction))
+                    continue;
+
+                Prefix[depth] = instruction;
+                if (Specification.Branch == null)
+                {
+                    if (MatchesExpected(next))
+                        Accept(Prefix.Take(depth + 1), nextCost);
+                }
+                else
+                {
+                    foreach (var branch in Branches)
+                    {
+                        var branchCost = Add(nextCost, branch);
+                        if (branchCost.CompareTo(BestCost) >= 0)
+                            continue;
+                        if (MatchesExpectedAfter(next, branch))
+                            Accept(Prefix.Take(depth + 1).Append(branch), branchCost);
+                    }
+                }
+
+                if (depth + 1 < MaxLength)
+                    Search(depth + 1, nextCost);
+            }
+        }
+
+        private void Accept(IEnumerable<Instruction> candidate, (int Primary, int Secondary) cost)
+        {
+            var instructions = candidate.ToImmutableArray();
+            if (!IsEquivalent(instructions))
+                return;
+            Best = instructions;
+            BestCost = cost;
+        }
+
+        /// <summary>
+        /// Checks a candidate against the reference for every value of every global and constant, with the carry both set and clear.
+        /// A, INTERNAL_RESERVED_0, and the other flags start out as junk that changes from case to case, so a candidate
+        /// can't get away with depending on them.
+        /// </summary>
+        private bool IsEquivalent(ImmutableArray<Instruction> candidate)
+        {
+            var reference = Specification.ReferenceWithBranch;
+            var inputCount = Specification.InputCount;
+            var caseCount = 1L << (inputCount * 8);
+            for (var inputs = 0L; inputs < caseCount; inputs++)
+            {
+                var memory = (ulong)inputs & GlobalsMask;
+                var constants = (ulong)inputs >> (Specification.GlobalCount * 8);
+                for (var carryBit = 0; carryBit < 2; carryBit++)
+                {
+                    var carry = carryBit == 1;
+                    var junk = Scramble((ulong)inputs, carry);
+                    var initial = new MachineState
+                    {
+                        A = (byte)junk,
+                        Carry = carry,
+                        Zero = (junk & 0x100) != 0,
+                        Negative = (junk & 0x200) != 0,
+                        Memory = memory | ((junk >> 16) & 0xFF) << (MachineState.ReservedIndex * 8)
+                    };
+                    var expected = Run(reference, initial, constants);
+                    var actual = Run(candidate, initial, constants);
+                    if (expected == null || actual == null || !actual.Value.IsObservablyEqual(expected.Value, GlobalsMask))
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        private bool TryExecute(MachineState[] current, MachineState[] next, Instruction instruction)
+        {
+            for (var i = 0; i < current.Length; i++)
+            {
+                next[i] = current[i];
+                if (!next[i].Execute(instruction, Vectors[i].Constants))
+                    return false;
+            }
+            return true;
+        }
+
+        private bool MatchesExpected(MachineState[] states)
+        {
+            for (var i = 0; i < states.Length; i++)
+            {
+                if (!states[i].IsObservablyEqual(Expected[i], GlobalsMask))
+                    return false;
+            }
+            return true;
+        }
+
+        private bool MatchesExpectedAfter(MachineState[] states, Instruction branch)
+        {
+            for (var i = 0; i < states.Length; i++)
+            {
+                var state = states[i];
+                state.Execute(branch, Vectors[i].Constants);
+                if (!state.IsObservablyEqual(Expected[i], GlobalsMask))
+                    return false;
+            }
+            return true;
+        }
+
+        private MachineState RunReference(MachineState initial, ulong constants)
+            => Run(Specification.ReferenceWithBranch, initial, constants)
+            ?? throw new InvalidOperationException($"Reference for '{Specification.Shape}' can't be executed.");
+
+        private static MachineState? Run(ImmutableArray<Instruction> instructions, MachineState state, ulong constants)
+        {
+            foreach (var instruction in instructions)
+            {
+                if (!state.Execute(instruction, constants))
+                    return null;
+            }
+            return state;
+        }
+
+        private (int Primary, int Secondary) CostOf(IEnumerable<Instruction> instructions)
+            => instructions.Aggregate((0, 0), (cost, instruction) => Add(cost, instruction));
+
+        private (int Primary, int Secondary) Add((int Primary, int Secondary) cost, Instruction instruction)
+            => Metric == CostMetric.Cycles
+            ? (cost.Primary + instruction.Cycles, cost.Secondary + instruction.Bytes)
+            : (cost.Primary + instruction.Bytes, cost.Secondary + instruction.Cycles);
+
+        /// <summary>Skips pairs that can never be part of the cheapest sequence, to keep the search space down.</summary>
+        private static bool IsRedundant(Instruction previous, Instruction instruction)
+        {
+            return (SetsCarry(previous.Opcode) && SetsCarry(instruction.Opcode))
+                || (previous.Opcode == Opcode.LDA && instruction.Opcode == Opcode.LDA)
+                || (previous.Opcode == Opcode.PHA && instruction.Opcode == Opcode.PLA);
+
+            static bool SetsCarry(Opcode opcode) => opcode is Opcode.CLC or Opcode.SEC;
+        }
+
+        private static IEnumerable<Instruction> CreateAlphabet(Specification specification)
+        {
+            var memory = Enumerable.Range(0, specification.GlobalCount)
+                .Select(i => new Operand(OperandKind.Global, i))
+                .Append(Operand.Reserved)
+                .ToImmutableArray();
+            var immediates = Enumerable.Range(0, specification.ConstantCount)
+                .Select(i => new Operand(OperandKind.Constant, i))
+                .Concat(new[] { 0x00, 0x01, 0xFF }.Select(v => new Operand(OperandKind.Immediate, v)))
+                .ToImmutableArray();
+
+            foreach (var opcode in new[] { Opcode.LDA, Opcode.ADC, Opcode.SBC, Opcode.AND, Opcode.ORA, Opcode.EOR, Opcode.CMP })
+            {
+                foreach (var operand in immediates.Concat(memory))
+                    yield return new Instruction(opcode, operand);
+            }
+            foreach (var operand in memory)
+                yield return new Instruction(Opcode.STA, operand);
+            foreach (var opcode in new[] { Opcode.INC, Opcode.DEC, Opcode.ASL, Opcode.LSR, Opcode.ROL, Opcode.ROR })
+            {
+                foreach (var operand in memory)
+                    yield return new Instruction(opcode, operand);
+                if (opcode is not (Opcode.INC or Opcode.DEC))
+                    yield return new Instruction(opcode, Operand.Accumulator);
+            }
+            foreach (var opcode in new[] { Opcode.CLC, Opcode.SEC, Opcode.PHA, Opcode.PLA })
+                yield return new Instruction(opcode, Operand.None);
+        }
+
+        /// <summary>A handful of cases covering the usual edge values plus pseudo-random ones, to reject most candidates cheaply.</summary>
+        private static IEnumerable<(MachineState State, ulong Constants)> CreateFilterVectors(Specification specification)
+        {
+            var random = new Random(2600);
+            for (var i = 0; i < FilterVectorCount; i++)
+            {
+                var inputs = new byte[specification.InputCount];
+                for (var j = 0; j < inputs.Length; j++)
+                    inputs[j] = i < InterestingValues.Length ? InterestingValues[(i + j) % InterestingValues.Length] : (byte)random.Next(256);
+
+                var memory = 0UL;
+                for (var j = 0; j < specification.GlobalCount; j++)
+                    memory |= (ulong)inputs[j] << (j * 8);
+                memory |= (ulong)random.Next(256) << (MachineState.ReservedIndex * 8);
+                var constants = 0UL;
+                for (var j = 0; j < specification.ConstantCount; j++)
+                    constants |= (ulong)inputs[specification.GlobalCount + j] << (j * 8);
+
+                yield return (new MachineState
+                {
+                    A = (byte)random.Next(256),
+                    Carry = (i & 1) != 0,
+                    Zero = random.Next(2) == 0,
+                    Negative = random.Next(2) == 0,
+                    Memory = memory
+                }, constants);
+            }
+        }
+
+        private static ulong Scramble(ulong inputs, bool carry)
+        {
+            var value = (inputs * 2 + (carry ? 1UL : 0UL) + 1) * 0x9E3779B97F4A7C15UL;
+            return value ^ (value >> 29);
+        }
+    }
+}